@@ -28,6 +28,7 @@ extern "C" {
     //
 
 #define GGWAVE_MAX_INSTANCES 4
+#define GGWAVE_MAX_RX_PAYLOAD_LENGTHS 4
 
     // Data format of the audio samples
     typedef enum {
@@ -93,6 +94,70 @@ extern "C" {
     //   GGWAVE_OPERATING_MODE_USE_DSS:
     //     Enable the built-in Direct Sequence Spread (DSS) algorithm
     //
+    //   GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS:
+    //     Do not analyze the captured variable-length data inside decode(). Instead, the capture
+    //     is handed over to ggwave_rxAnalyze(), which should be called from a separate thread.
+    //     The result is delivered by the next decode() call after the analysis is done.
+    //     Up to GGWave::kMaxRecordingSlots receptions are recorded while earlier ones are
+    //     still being analyzed. Ignored on Arduino.
+    //
+    //   GGWAVE_OPERATING_MODE_TX_STREAM:
+    //     The waveform is generated frame by frame with GGWave::encodeFrame() into a buffer
+    //     provided by the caller. The buffers for the full waveform are not allocated, so
+    //     encode() is not available.
+    //
+    //   GGWAVE_OPERATING_MODE_TX_IFFT:
+    //     Synthesize each Tx frame with a single inverse FFT of the active tones instead of
+    //     summing precomputed tone waveforms. The cost per frame does not depend on the number
+    //     of tones and the tone waveforms are not allocated. Useful for wide custom protocols.
+    //
+    //   GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER:
+    //     Convert the capture from sampleRateInp to the operating sample rate with a short
+    //     resampling filter (Resampler::kWidthFast) instead of the default one. Meant for
+    //     capturing at the device sample rate: the conversion costs much less, at the price of
+    //     more attenuation and aliasing near the Nyquist frequency of the operating sample rate.
+    //     The operating sample rate and the Tx path are not affected. No effect when the
+    //     capture is not resampled.
+    //
+    //   GGWAVE_OPERATING_MODE_RX_BAND_ONLY:
+    //     Compute the Rx power spectrum only in the bins used by the protocols enabled at
+    //     preparation: from the lowest freqStart to the highest freqStart + 2*16*bytesPerTx.
+    //     The other bins of the spectrum stay zero. In fixed-length mode the spectrum is
+    //     normalized by its maximum in these bins only.
+    //
+    //   GGWAVE_OPERATING_MODE_RX_HETERODYNE:
+    //     Mix the band of the Rx protocols enabled at preparation down to baseband, low-pass
+    //     filter and decimate each captured frame before the analysis. The band is shifted down
+    //     in the Rx spectrum and in the freqStart of rxProtocols(). Meant for protocols whose
+    //     band lies high in the spectrum, for example moved to ultrasound frequencies at 96 kHz
+    //     with ggwave_rxProtocolSetFreqStart(). The band has to fit below the Nyquist frequency:
+    //     the default [U] protocols use bins 480 - 576 of samplesPerFrame/2 = 512 and cannot be
+    //     received at any sample rate.
+    //
+    //     The low-pass front end of GGWAVE_OPERATING_MODE_RX_DECIMATE is used instead when it
+    //     allows a larger decimation.
+    //
+    //   GGWAVE_OPERATING_MODE_RX_DECIMATE:
+    //     Low-pass filter and decimate each captured frame when the band of the Rx protocols
+    //     enabled at preparation lies low enough (for example the audible protocols at 22.05 kHz
+    //     or the DT/MT protocols at 11.025 kHz). The bins stay in place. When the input is
+    //     resampled, the resampler outputs the decimated rate directly.
+    //
+    //     With either front end the spectrum, the marker detection and the analysis run on
+    //     rxSamplesPerFrame() = samplesPerFrame/D samples per frame with the same bin spacing,
+    //     so rxSpectrum() and computeFFTR() use rxSamplesPerFrame() bins. D is the largest power
+    //     of 2 for which the filter stays short. Without these flags rxSamplesPerFrame() is
+    //     samplesPerFrame().
+    //
+    //   GGWAVE_OPERATING_MODE_RX_ENERGY_GATE:
+    //     Skip the Rx spectrum and the marker checks while the captured frames stay close to a
+    //     tracked noise floor. The energy is measured with a short band-pass filter over the
+    //     bins of the enabled Rx protocols that lie below the Nyquist frequency, so the noise
+    //     outside of them does not hide a transmission. The floor follows the energy down
+    //     immediately and up slowly. The fraction of skipped frames is given by
+    //     rxEnergyGateHitRate(). Meant for receivers that are idle most of the time. Signals
+    //     much weaker than the noise in the protocol band may be missed.
+    //
     enum {
         GGWAVE_OPERATING_MODE_RX            = 1 << 1,
         GGWAVE_OPERATING_MODE_TX            = 1 << 2,
@@ -100,6 +165,14 @@ extern "C" {
                                                GGWAVE_OPERATING_MODE_TX),
         GGWAVE_OPERATING_MODE_TX_ONLY_TONES = 1 << 3,
         GGWAVE_OPERATING_MODE_USE_DSS       = 1 << 4,
+        GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS = 1 << 5,
+        GGWAVE_OPERATING_MODE_TX_STREAM         = 1 << 6,
+        GGWAVE_OPERATING_MODE_TX_IFFT           = 1 << 7,
+        GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER = 1 << 8,
+        GGWAVE_OPERATING_MODE_RX_BAND_ONLY      = 1 << 9,
+        GGWAVE_OPERATING_MODE_RX_HETERODYNE     = 1 << 10,
+        GGWAVE_OPERATING_MODE_RX_ENERGY_GATE    = 1 << 11,
+        GGWAVE_OPERATING_MODE_RX_DECIMATE       = 1 << 12,
     };
 
     // GGWave instance parameters
@@ -340,10 +413,38 @@ extern "C" {
             ggwave_ProtocolId protocolId,
             int freqStart);
 
+    // Set more fixed payload lengths to receive
+    //
+    //   lengths - the payload lengths, 0 - unused
+    //   n       - number of lengths, at most GGWAVE_MAX_RX_PAYLOAD_LENGTHS
+    //
+    //   With a fixed payloadLength, newly constructed GGWave instances also accept payloads of
+    //   these lengths. All the lengths share the spectrum analysis, so the cost of each additional
+    //   length is small. Call with n = 0 to receive only payloadLength.
+    //
+    //   Note that this function does not affect instances that have already been created.
+    //
+    //   Returns 1 on success, 0 on failure
+    //
+    GGWAVE_API int ggwave_rxSetPayloadLengths(
+            const int * lengths,
+            int n);
+
     // Return recvDuration_frames value for a rx protocol
     GGWAVE_API int ggwave_rxDurationFrames(
             ggwave_Instance instance);
 
+    // Analyze the captured data that was handed over by ggwave_decode()
+    //
+    //   Only used with GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS. Can be called from a single
+    //   thread other than the one calling ggwave_decode().
+    //
+    //   Returns 1 if captured data was analyzed, 0 if there was nothing to analyze,
+    //   -1 if the instance is not valid
+    //
+    GGWAVE_API int ggwave_rxAnalyze(
+            ggwave_Instance instance);
+
 #ifdef __cplusplus
 }
 
@@ -410,6 +511,10 @@ public:
 #include <stdint.h>
 #include <stdio.h>
 
+#ifndef ARDUINO
+#include <atomic>
+#endif
+
 #ifdef ARDUINO
 #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARDUINO_NANO33BLE) || defined(ARDUINO_ARCH_MBED_RP2040) || defined(ARDUINO_ARCH_RP2040)
 #include <avr/pgmspace.h>
@@ -434,6 +539,7 @@ public:
     static constexpr auto kMaxLengthFixed              = 64;
     static constexpr auto kMaxSpectrumHistory          = 8;
     static constexpr auto kMaxRecordedFrames           = 2048;
+    static constexpr auto kMaxRecordingSlots           = 2;
 
     using Parameters    = ggwave_Parameters;
     using SampleFormat  = ggwave_SampleFormat;
@@ -565,6 +671,49 @@ public:
     using RecordedData = ggvector<float>;
     using TxRxData     = ggvector<uint8_t>;
 
+    // Real FFT backend
+    //
+    //   All spectral computations go through a backend with the in-place layout of Ooura's rdft():
+    //
+    //     a[2*k] = R[k], a[2*k + 1] = I[k] for 0 < k < N/2, a[0] = R[0], a[1] = R[N/2]
+    //
+    //   isgn = 1 computes the forward transform and isgn = -1 the inverse one, without the 2/N scaling.
+    //   Set wi[0] = 0 before the first call with a given N - the backend keeps its tables in wi and wf.
+    //
+    struct FFTBackend {
+        const char * name;
+
+        int  (*workSizeI)(int N);
+        int  (*workSizeF)(int N);
+        void (*rdft)(int N, int isgn, float * a, int * wi, float * wf);
+    };
+
+    // Built-in FFT backends
+    //
+    //   fftBackendOoura() - the portable scalar implementation
+    //   fftBackendAuto()  - the fastest built-in backend for this CPU: a vectorized radix-4 FFT when
+    //                       SSE2, AVX2 or NEON is available, otherwise Ooura
+    //
+    static const FFTBackend & fftBackendOoura();
+    static const FFTBackend & fftBackendAuto();
+
+    // Set the FFT backend used by GGWave instances prepared after this call
+    //
+    //   Pass nullptr to use fftBackendAuto() (the default).
+    //
+    //   Note: not thread-safe. Instances keep the backend they were prepared with
+    //
+    static void setFFTBackend(const FFTBackend * backend);
+    static const FFTBackend & fftBackend();
+
+    // Set more fixed payload lengths to receive for GGWave instances prepared after this call
+    //
+    //   See ggwave_rxSetPayloadLengths()
+    //
+    //   Note: not thread-safe. Instances keep the lengths they were prepared with
+    //
+    static bool setRxPayloadLengths(const int * lengths, int n);
+
     // Default constructor
     //
     //   The GGWave object is not ready to use until you call prepare()
@@ -672,6 +821,21 @@ public:
     //
     uint32_t encode();
 
+    // Max size of a single frame generated by encodeFrame() in bytes
+    uint32_t encodeFrameSize_bytes() const;
+
+    // Encode the next frame of the Tx data into an audio waveform
+    //
+    //   dst - buffer of at least encodeFrameSize_bytes() bytes
+    //
+    //   Alternative to encode() that generates the waveform one frame at a time, so the playback
+    //   can start right after the first frame. Call it repeatedly after init() until txHasData()
+    //   becomes false. The samples are in the format given by sampleFormatOut().
+    //
+    //   Returns the number of bytes written to dst
+    //
+    uint32_t encodeFrame(void * dst);
+
     // Decode an audio waveform
     //
     //   data   - pointer to the waveform data
@@ -684,6 +848,17 @@ public:
     //
     bool decode(const void * data, uint32_t nBytes);
 
+    // Decode an audio waveform, reading the samples in place when possible
+    //
+    //   Same as decode(), but whole frames of 32-bit float samples at the operating sample rate are analyzed
+    //   straight from the caller buffer instead of being copied first. Only the samples of an incomplete
+    //   frame at the end of the buffer are kept, so a ring buffer can be passed one contiguous region at a
+    //   time.
+    //
+    //   rxAmplitude() and rxTakeAmplitude() are not updated for frames analyzed in place.
+    //
+    bool decodeInPlace(const void * data, uint32_t nBytes);
+
     //
     // Instance state
     //
@@ -737,14 +912,39 @@ public:
     bool rxAnalyzing() const;
 
     int rxSamplesNeeded()       const;
+    int rxSamplesPerFrame()     const; // samples per analyzed frame, after the Rx front end
     int rxFramesToRecord()      const;
     int rxFramesLeftToRecord()  const;
     int rxFramesToAnalyze()     const;
     int rxFramesLeftToAnalyze() const;
     int rxDurationFrames()      const;
 
+    // fraction of the captured frames for which the energy gate skipped the spectral processing
+    float rxEnergyGateHitRate() const;
+
+    // fixed-length decoding: candidate windows that passed the tone detection, and how far they got before or
+    // through the Reed-Solomon decoding
+    struct RxStatsFixed {
+        int64_t nCandidates    = 0;
+        int64_t nUnfixable     = 0; // rejected - more bytes with a missing tone than a correction may change
+        int64_t nSyndromeOk    = 0; // accepted without correction
+        int64_t nCorrections   = 0; // full corrections attempted, with the uncertain bytes as erasures
+        int64_t nCorrected     = 0; // full corrections that succeeded
+    };
+
+    const RxStatsFixed & rxStatsFixed() const;
+
     bool rxStopReceiving();
 
+    // Analyze the captured data handed over by decode()
+    //
+    //   Only used with GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS. Can be called from a single
+    //   thread concurrently with decode(). The result is delivered by the next decode() call.
+    //
+    //   Returns true if captured data was analyzed
+    //
+    bool rxAnalyze();
+
     // The instance will attempt to decode only these protocols.
     // They are determined upon construction or when calling the prepare() method, base on the contents of the global
     // GGWave::Protocols::rx()
@@ -784,7 +984,7 @@ public:
     //   src - input real-valued data, size is N
     //   dst - output complex-valued data, size is 2*N
     //
-    //   N must be == samplesPerFrame()
+    //   N must be == rxSamplesPerFrame()
     //
     bool computeFFTR(const float * src, float * dst, int N);
 
@@ -792,8 +992,10 @@ public:
     //
     //   src - input real-valued data, size is N
     //   dst - output complex-valued data, size is 2*N
-    //   wi  - work buffer, with size 2*N
-    //   wf  - work buffer, with size 3 + sqrt(N/2)
+    //   wi  - work buffer, with the size returned for wi == nullptr
+    //   wf  - work buffer, with the size returned for wf == nullptr
+    //
+    //   Uses the backend returned by fftBackend().
     //
     //   First time calling this function, make sure that wi[0] == 0
     //   This will initialize some internal coefficients and store them in wi and wf for
@@ -829,6 +1031,18 @@ public:
     static int filter(ggwave_Filter filter, float * waveform, int N, float p0, float p1, float * w);
 
     // Resample audio waveforms from one sample rate to another using sinc interpolation
+    //
+    //   Each output sample is a dot product of the 2*width neighboring input samples with a
+    //   windowed-sinc filter phase, where width is kWidth unless given to alloc(). The time of
+    //   the output samples is tracked in integer units of 1/den input samples, where num/den is
+    //   the ratio of the rates (rounded to kFracBits fractional bits if the rates are not
+    //   integers):
+    //
+    //     - if den <= kMaxExactPhases (e.g. 48000 <-> 44100, 96000 <-> 48000), all phases are
+    //       tabulated exactly
+    //     - otherwise the output is interpolated linearly between the two nearest of kPhases
+    //       tabulated phases
+    //
     class Resampler {
     public:
         // this controls the number of neighboring samples
@@ -836,41 +1050,56 @@ public:
         // processing time is linearly related to this width
         static const int kWidth = 64;
 
+        // shorter width for the conversion of the capture in GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER
+        static const int kWidthFast = 8;
+
         Resampler();
 
-        bool alloc(void * p, int & n);
+        // width - the number of neighboring samples used, at most kWidth and a multiple of 4
+        bool alloc(float sampleRateInp, float sampleRateOut, void * p, int & n, int width = kWidth);
 
         void reset();
 
         int nSamplesTotal() const { return m_state.nSamplesTotal; }
 
+        // number of samples that the next resample() call with nSamplesInp input samples will produce
+        int nSamplesOut(int nSamplesInp) const;
+
+        // minimum number of input samples for the next resample() call to produce nSamplesOut samples
+        int nSamplesInp(int nSamplesOut) const;
+
+        // returns the number of samples written to samplesOut
         int resample(
-                float factor,
                 int nSamples,
                 const float * samplesInp,
                 float * samplesOut);
 
     private:
-        float getData(int j) const;
-        void newData(float data);
-        void makeSinc();
-        double sinc(double x) const;
+        int resampleBlock(int nSamples, const float * samplesInp, float * samplesOut);
+        void makeFilter();
+
+        static const int kPhases         = 64;
+        static const int kFracBits       = 24;
+        static const int kMaxExactPhases = 160;
+        static const int kMaxSamplesInp  = 4096; // longer inputs are processed in blocks
 
-        static const int kDelaySize = 140;
+        int m_width = kWidth;
+        int m_taps  = 2*kWidth;
 
-        // this defines how finely the sinc function is sampled for storage in the table
-        static const int kSamplesPerZeroCrossing = 32;
+        // input samples per output sample = num/den
+        bool m_isExact = false;
+        int  m_num     = 1;
+        int  m_den     = 1;
 
-        ggvector<float> m_sincTable;
-        ggvector<float> m_delayBuffer;
-        ggvector<float> m_edgeSamples;
-        ggvector<float> m_samplesInp;
+        ggvector<float> m_filter;     // [m_isExact ? den : kPhases + 1][m_taps]
+        ggvector<float> m_samplesInp; // last m_taps input samples followed by the new ones
 
         struct State {
             int nSamplesTotal = 0;
-            int timeInt       = 0;
-            int timeLast      = 0;
-            double timeNow    = 0.0;
+
+            // time of the next output sample in input samples from the start of m_samplesInp
+            int timeInt   = 0;
+            int timePhase = 0; // in units of 1/den
         };
 
         State m_state;
@@ -879,17 +1108,52 @@ public:
 private:
     bool alloc(void * p, int & n);
 
+    bool decode(const void * data, uint32_t nBytes, bool inPlace);
+
+    // choose the decimation of the Rx front end for the band of the enabled Rx protocols
+    void planRxFrontEnd();
+
+    // pass the frame in m_rx.frame through the Rx front end and decode it
+    void decodeFrame();
+    void decimateFrame();
+    int frontEndStride() const;
+    void updateEnergyGate();
+
     void decode_fixed();
     void decode_variable();
 
+    // Reed-Solomon encoding, tones and tone waveforms for the current Tx data
+    void encodePrepare();
+
+    // render the next Tx frame into m_tx.outputResampled, returns the number of samples
+    int encodeNextFrame();
+
     int maxFramesPerTx(const Protocols & protocols, bool excludeMT) const;
     int minBytesPerTx(const Protocols & protocols) const;
     int maxBytesPerTx(const Protocols & protocols) const;
     int maxTonesPerTx(const Protocols & protocols) const;
     int minFreqStart(const Protocols & protocols) const;
+    int maxFreqEnd(const Protocols & protocols) const;
 
     double bitFreq(const Protocol & p, int bit) const;
 
+    // number of detected marker bits in the given spectrum
+    int nMarkerBits(const Spectrum & spectrum, const Protocol & protocol, bool isStart) const;
+
+    // spectrum of the sum of nFrames consecutive frames of a recording slot, starting at the given sample
+    // the result is stored in m_analysis.spectrum
+    void recordedSpectrum(int slot, int offset, int nFrames);
+
+    // variable-length analysis of a recording slot
+    // uses only the m_analysis buffers and the recording, so it can run on another thread
+    void analyze(int slot);
+
+    // publish the result of the oldest recording, if its analysis is done
+    void deliverAnalysis();
+
+    // recording slot that is not in use by the analysis, -1 if none
+    int freeRecordingSlot() const;
+
     // Initialized via prepare()
     float        m_sampleRateInp        = -1.0f;
     float        m_sampleRateOut        = -1.0f;
@@ -915,12 +1179,25 @@ private:
 
     bool         m_isFixedPayloadLength = false;
     int          m_payloadLength        = -1;
+    int          m_nPayloadLengthsRx    = 0;
+    int          m_payloadLengthsRx[GGWAVE_MAX_RX_PAYLOAD_LENGTHS + 1]; // ascending, with m_payloadLength
 
     bool         m_isRxEnabled          = false;
     bool         m_isTxEnabled          = false;
-    bool         m_needResampling       = false;
+    bool         m_needResamplingInp    = false;
+    bool         m_needResamplingOut    = false;
     bool         m_txOnlyTones          = false;
     bool         m_isDSSEnabled         = false;
+    bool         m_isAsyncAnalysis      = false;
+    bool         m_isTxStream           = false;
+    bool         m_isTxIFFT             = false;
+    bool         m_isRxFastResampler    = false;
+    bool         m_isRxBandOnly         = false;
+    bool         m_isRxHeterodyne       = false;
+    bool         m_isRxEnergyGate       = false;
+    bool         m_isRxDecimate         = false;
+
+    const FFTBackend * m_fftBackend     = nullptr;
 
     // Common
     TxRxData m_dataEncoded;
@@ -938,6 +1215,19 @@ private:
         int recvDuration_frames = 0;
         int minFreqStart        = 0;
 
+        // spectrum bins [binStart, binEnd) used by the enabled protocols
+        int binStart            = 0;
+        int binEnd              = 0;
+
+        // front end - each captured frame is band-limited and decimated to samplesPerFrame samples
+        int   samplesPerFrame    = 0;
+        int   samplesPerFrameInp = 0;    // collected per frame - samplesPerFrame if the resampler decimates
+        int   decimation         = 1;
+        bool  isHeterodyne       = false;
+        int   binShift           = 0;    // capture bin = analysis bin + binShift
+        int   frontEndTaps       = 0;    // 0 if the input resampler decimates
+        float frontEndCutoff     = 0.0f; // of the low-pass prototype, in cycles per captured sample
+
         int framesLeftToAnalyze = 0;
         int framesLeftToRecord  = 0;
         int framesToAnalyze     = 0;
@@ -955,7 +1245,26 @@ private:
         Spectrum  spectrum;
         Amplitude amplitude;
         Amplitude amplitudeResampled;
-        TxRxData  amplitudeTmp;
+
+        // the frame being analyzed - either amplitude, a frame in the caller buffer or frameDecimated
+        const float * frame = nullptr;
+
+        ggvector<float> frontEndTapsI;  // low-pass or in-phase part of the band-pass filter, in polyphase order
+        ggvector<float> frontEndTapsQ;  // quadrature part, heterodyne only
+        ggvector<float> frontEndMixCos; // [samplesPerFrame] mixing of the filtered band down to baseband
+        ggvector<float> frontEndMixSin;
+        ggvector<float> frontEndInput;  // last nTaps - 1 captured samples followed by the current frame
+        ggvector<float> frontEndPhases; // [decimation][stride] polyphase components of frontEndInput
+        ggvector<float> frameDecimated;
+        ggvector<float> frameQuadrature; // [samplesPerFrame] heterodyne only
+
+        // energy gate - mean square of the analyzed frames in the band of the Rx protocols
+        ggvector<float> gateTaps; // band-pass filter, a multiple of 8 taps
+
+        float   noiseFloor     = 0.0f;
+        int     framesGated    = 0; // consecutive frames below the gate
+        int64_t nFramesGate    = 0;
+        int64_t nFramesSkipped = 0;
 
         int dataLength = 0;
 
@@ -965,22 +1274,95 @@ private:
         RxProtocols  protocols;
 
         // variable-length decoding
-        int historyId = 0;
+        int historyId     = 0;
+        int historyResync = 0;
 
-        Amplitude    amplitudeAverage;
+        Amplitude    amplitudeSum; // running sum of the frames in amplitudeHistory
         AmplitudeArr amplitudeHistory;
-        RecordedData amplitudeRecorded;
+        AmplitudeArr amplitudeRecorded; // [slot][sample]
+
+        int recordingSlot = 0;
+
+        // fixed-length decoding - the quantized spectrum of the newest frame over the union of the protocol bands. a
+        // slot is the 16 bins of a tone group, shared by all groups at the same bin
+        int nSlotsFixed = 0;
+
+        ggvector<int>     slotBinFixed;  // [slot] first spectrum bin, ascending
+        ggvector<uint8_t> spectrumFixed; // [slot][16]
+
+        // tone votes, updated once per frame. a tone group is the 16 bins of one nibble of a protocol. the rings are
+        // indexed by voteRow, the row of the newest frame, and store 1 + tone or 0 for no tone
+        int voteRow = 0;
+
+        ggvector<int>     voteGroupStart;     // [protocol + 1] first tone group of each protocol
+        ggvector<int>     voteGroupSlot;      // [group] slot of the group in spectrumFixed, -1 if outside the spectrum
+        ggmatrix<uint8_t> voteTone;           // [row][group] loudest tone of the frame, with kToneConfident for a clear peak
+        ggmatrix<uint8_t> voteMajority;       // [row][group] tone with more than framesPerTx/2 votes in the framesPerTx frames ending at the row
+        ggmatrix<uint8_t> voteConfident;      // [row][group] 1 if more than framesPerTx/2 of these frames have a clear peak
+        ggvector<uint8_t> voteCount;          // [group][16] votes in the last framesPerTx frames
+        ggvector<uint8_t> voteConfidentCount; // [group] frames with a clear peak in the last framesPerTx frames
+        ggmatrix<int16_t> voteDetected;       // [row][protocol] number of groups with a majority
+        ggmatrix<int16_t> voteDetectedSum;    // [row][length][protocol] voteDetected of the Txs with complete bytes in the window ending at the row
+
+        ggvector<uint8_t> nibblesDetected;    // [byte] nibbles with a majority tone, of the candidate being checked
+        ggvector<uint8_t> nibblesConfident;   // [byte] nibbles with a clear peak, of the candidate being checked
+        ggvector<uint8_t> erasures;           // [ECC byte] positions of the bytes passed to Reed-Solomon as erasures
+        ggvector<uint8_t> eccDecoded;         // [ECC byte] ECC bytes of the corrected payload
+        RxStatsFixed      statsFixed;
+
+        // the last decoded payload. a longer length can decode it again from a window that contains it, so such
+        // candidates are rejected
+        int lastProtocolId  = -1;
+        int lastLength      = 0;
+        int lastWindow      = 0; // frames
+        int framesSinceLast = 0;
+    } m_rx;
 
-        // fixed-length decoding
-        int historyIdFixed = 0;
+    // recording slot - owned by decode() while idle, by analyze() while pending or running
+    struct Recording {
+#ifdef ARDUINO
+        volatile int state = 0; // see kAnalysis* in ggwave.cpp. no <atomic> and no async analysis on Arduino
+#else
+        std::atomic<int> state { 0 }; // see kAnalysis* in ggwave.cpp
+#endif
 
-        ggmatrix<uint8_t> spectrumHistoryFixed;
-        ggvector<uint8_t> detectedBins;
-        ggvector<uint8_t> detectedTones;
-    } m_rx;
+        uint32_t id = 0; // hand-over order, see nHandedOver
+
+        // snapshot of the reception
+        int recvDuration_frames = 0;
+        int markerFreqStart     = 0;
+
+        // result
+        bool         isValid = false;
+        int          dataLength = 0;
+        TxRxData     data;
+        RxProtocolId protocolId;
+    };
+
+    // variable-length analysis
+    struct Analysis {
+        int      nRecordings = 0; // number of recording slots in use
+        uint32_t nHandedOver = 0; // number of recordings handed over for analysis, wraps around
+
+        Recording recordings[kMaxRecordingSlots];
+
+        ggvector<float> fftOut; // complex
+        ggvector<int>   fftWorkI;
+        ggvector<float> fftWorkF;
+
+        Spectrum spectrum;
+
+        TxRxData dataEncoded;
+        TxRxData workRSLength;
+        TxRxData workRSData;
+    } m_analysis;
 
     struct Tx {
-        bool hasData = false;
+        bool hasData    = false;
+        bool isEncoding = false; // encodeFrame() is in the middle of the waveform
+
+        int frameId = 0; // next frame to render
+        int nFrames = 0;
 
         float sendVolume = 0.1f;
 
@@ -990,9 +1372,27 @@ private:
         ggvector<bool> dataBits;
         ggvector<double> phaseOffsets;
 
+        // FFT bin and phase of the bit1 tone of each data bit
+        ggvector<int>   toneBins;
+        ggvector<float> toneSinPhase;
+        ggvector<float> toneCosPhase;
+
+        // one period of sin / cos over a frame, used to build the tone waveforms
+        ggvector<float> sinTable;
+        ggvector<float> cosTable;
+
+        // the tone waveforms depend only on these protocol parameters, so they are reused until they change
+        int toneFreqStart     = -1;
+        int toneDataBitsPerTx = -1;
+
         AmplitudeArr bit1Amplitude;
         AmplitudeArr bit0Amplitude;
 
+        // GGWAVE_OPERATING_MODE_TX_IFFT
+        Amplitude       synthSpectrum; // active tones of the current frame, synthesized in-place
+        ggvector<int>   synthWorkI;
+        ggvector<float> synthWorkF;
+
         TxRxData    data;
         TxProtocol  protocol;
         TxProtocols protocols;
@@ -1006,7 +1406,8 @@ private:
         Tones tones;
     } m_tx;
 
-    mutable Resampler m_resampler;
+    Resampler m_resamplerInp; // capture rate -> operating rate
+    Resampler m_resamplerOut; // operating rate -> playback rate
 
     void * m_heap  = nullptr;
     int m_heapSize = 0;
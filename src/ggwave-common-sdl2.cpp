@@ -13,6 +13,9 @@
 #include <emscripten.h>
 #else
 #define EMSCRIPTEN_KEEPALIVE
+
+#include <atomic>
+#include <thread>
 #endif
 
 namespace {
@@ -27,6 +30,45 @@ SDL_AudioSpec g_obtainedSpecOut;
 
 std::shared_ptr<GGWave> g_ggWave = nullptr;
 
+// number of Tx frames to keep queued ahead of the playback
+constexpr int kTxFramesQueued = 4;
+
+#ifndef __EMSCRIPTEN__
+// analyzes the captured data off the audio loop, so that decode() never stalls on it
+std::thread       g_analysisWorker;
+std::atomic<bool> g_analysisRunning { false };
+#endif
+
+void stopAnalysisWorker() {
+#ifndef __EMSCRIPTEN__
+    g_analysisRunning = false;
+    if (g_analysisWorker.joinable()) {
+        g_analysisWorker.join();
+    }
+#endif
+}
+
+void startAnalysisWorker(bool asyncAnalysis) {
+#ifndef __EMSCRIPTEN__
+    stopAnalysisWorker();
+
+    if (asyncAnalysis == false) {
+        return;
+    }
+
+    auto instance = g_ggWave;
+
+    g_analysisRunning = true;
+    g_analysisWorker = std::thread([instance]() {
+        while (g_analysisRunning) {
+            if (instance->rxAnalyze() == false) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+#endif
+}
+
 }
 
 // JS interface
@@ -78,7 +120,9 @@ bool GGWave_init(
         const int captureId,
         const int payloadLength,
         const float sampleRateOffset,
-        const bool useDSS) {
+        const bool useDSS,
+        const bool nativeRate,
+        const bool asyncAnalysis) {
 
     if (g_devIdInp && g_devIdOut) {
         return false;
@@ -112,6 +156,10 @@ bool GGWave_init(
 
     bool reinit = false;
 
+    // with native rate, the devices are opened at their own sample rate. ggwave still operates at the default
+    // sample rate and converts the capture with its short resampling filter
+    const int allowedChanges = nativeRate ? SDL_AUDIO_ALLOW_FREQUENCY_CHANGE : 0;
+
     if (g_devIdOut == 0) {
         printf("Initializing playback ...\n");
 
@@ -128,10 +176,10 @@ bool GGWave_init(
 
         if (playbackId >= 0) {
             printf("Attempt to open playback device %d : '%s' ...\n", playbackId, SDL_GetAudioDeviceName(playbackId, SDL_FALSE));
-            g_devIdOut = SDL_OpenAudioDevice(SDL_GetAudioDeviceName(playbackId, SDL_FALSE), SDL_FALSE, &playbackSpec, &g_obtainedSpecOut, 0);
+            g_devIdOut = SDL_OpenAudioDevice(SDL_GetAudioDeviceName(playbackId, SDL_FALSE), SDL_FALSE, &playbackSpec, &g_obtainedSpecOut, allowedChanges);
         } else {
             printf("Attempt to open default playback device ...\n");
-            g_devIdOut = SDL_OpenAudioDevice(NULL, SDL_FALSE, &playbackSpec, &g_obtainedSpecOut, 0);
+            g_devIdOut = SDL_OpenAudioDevice(NULL, SDL_FALSE, &playbackSpec, &g_obtainedSpecOut, allowedChanges);
         }
 
         if (!g_devIdOut) {
@@ -161,7 +209,7 @@ bool GGWave_init(
     if (g_devIdInp == 0) {
         SDL_AudioSpec captureSpec;
         captureSpec = g_obtainedSpecOut;
-        captureSpec.freq = GGWave::kDefaultSampleRate + sampleRateOffset;
+        captureSpec.freq = nativeRate && g_devIdOut ? g_obtainedSpecOut.freq : GGWave::kDefaultSampleRate + sampleRateOffset;
         captureSpec.format = AUDIO_F32SYS;
         captureSpec.samples = 512;
 
@@ -169,11 +217,11 @@ bool GGWave_init(
 
         if (captureId >= 0) {
             printf("Attempt to open capture device %d : '%s' ...\n", captureId, SDL_GetAudioDeviceName(captureId, SDL_TRUE));
-            g_devIdInp = SDL_OpenAudioDevice(SDL_GetAudioDeviceName(captureId, SDL_TRUE), SDL_TRUE, &captureSpec, &g_obtainedSpecInp, 0);
+            g_devIdInp = SDL_OpenAudioDevice(SDL_GetAudioDeviceName(captureId, SDL_TRUE), SDL_TRUE, &captureSpec, &g_obtainedSpecInp, allowedChanges);
         } else {
             printf("Attempt to open default capture device ...\n");
             g_devIdInp = SDL_OpenAudioDevice(g_defaultCaptureDeviceName.empty() ? nullptr : g_defaultCaptureDeviceName.c_str(),
-                                            SDL_TRUE, &captureSpec, &g_obtainedSpecInp, 0);
+                                            SDL_TRUE, &captureSpec, &g_obtainedSpecInp, allowedChanges);
         }
         if (!g_devIdInp) {
             printf("Couldn't open an audio device for capture: %s!\n", SDL_GetError());
@@ -212,8 +260,15 @@ bool GGWave_init(
     }
 
     if (reinit) {
-        GGWave::OperatingMode mode = GGWAVE_OPERATING_MODE_RX_AND_TX;
+        GGWave::OperatingMode mode = GGWAVE_OPERATING_MODE_RX_AND_TX | GGWAVE_OPERATING_MODE_TX_STREAM;
         if (useDSS) mode |= GGWAVE_OPERATING_MODE_USE_DSS;
+        if (nativeRate) mode |= GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER;
+#ifndef __EMSCRIPTEN__
+        // the recording slots of the async analysis take ~8 MB each, so it is opt-in
+        if (asyncAnalysis) mode |= GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS;
+#endif
+
+        stopAnalysisWorker();
 
         g_ggWave = std::make_shared<GGWave>(GGWave::Parameters {
             payloadLength,
@@ -226,6 +281,8 @@ bool GGWave_init(
             sampleFormatOut,
             mode,
         });
+
+        startAnalysisWorker(mode & GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS);
     }
 
     return true;
@@ -234,7 +291,9 @@ bool GGWave_init(
 std::shared_ptr<GGWave> GGWave_instance() { return g_ggWave; }
 
 void GGWave_reset(void * parameters) {
+    stopAnalysisWorker();
     g_ggWave = std::make_shared<GGWave>(*(GGWave::Parameters *)(parameters));
+    startAnalysisWorker(((GGWave::Parameters *)(parameters))->operatingMode & GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS);
 }
 
 bool GGWave_mainLoop() {
@@ -271,11 +330,17 @@ bool GGWave_mainLoop() {
             tLastNoData = tNow;
         }
     } else {
-        SDL_PauseAudioDevice(g_devIdOut, SDL_TRUE);
+        SDL_PauseAudioDevice(g_devIdOut, SDL_FALSE);
         SDL_PauseAudioDevice(g_devIdInp, SDL_TRUE);
 
-        const auto nBytes = g_ggWave->encode();
-        SDL_QueueAudio(g_devIdOut, g_ggWave->txWaveform(), nBytes);
+        static std::vector<uint8_t> dataOut;
+        dataOut.resize(g_ggWave->encodeFrameSize_bytes());
+
+        const int nQueued = kTxFramesQueued*g_ggWave->samplesPerFrame()*g_ggWave->sampleSizeOut();
+        while (g_ggWave->txHasData() && (int) SDL_GetQueuedAudioSize(g_devIdOut) < nQueued) {
+            const auto nBytes = g_ggWave->encodeFrame(dataOut.data());
+            SDL_QueueAudio(g_devIdOut, dataOut.data(), nBytes);
+        }
     }
 
     return true;
@@ -286,6 +351,7 @@ bool GGWave_deinit() {
         return false;
     }
 
+    stopAnalysisWorker();
     g_ggWave.reset();
 
     SDL_PauseAudioDevice(g_devIdInp, 1);
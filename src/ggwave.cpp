@@ -11,6 +11,22 @@
 #include <stdio.h>
 //#include <random>
 
+// vectorized sample-format conversion: SSE2 / NEON when the target has them, plus an AVX2 variant on x86
+// that is selected at runtime. define GGWAVE_DISABLE_SIMD to use only the scalar code
+#ifndef GGWAVE_DISABLE_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GGWAVE_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GGWAVE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#if defined(GGWAVE_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+#define GGWAVE_SIMD_AVX2_DISPATCH
+#include <immintrin.h>
+#endif
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -38,9 +54,10 @@ namespace {
 FILE * g_fptr = stderr;
 GGWave * g_instances[GGWAVE_MAX_INSTANCES];
 
-double linear_interp(double first_number, double second_number, double fraction) {
-    return (first_number + ((second_number - first_number)*fraction));
-}
+const GGWave::FFTBackend * g_fftBackend = nullptr;
+
+// more fixed payload lengths to receive, 0 - unused
+int g_payloadLengthsRx[GGWAVE_MAX_RX_PAYLOAD_LENGTHS];
 
 }
 
@@ -58,16 +75,7 @@ extern "C"
 ggwave_Instance ggwave_init(ggwave_Parameters parameters) {
     for (ggwave_Instance id = 0; id < GGWAVE_MAX_INSTANCES; ++id) {
         if (g_instances[id] == nullptr) {
-            g_instances[id] = new GGWave({
-                parameters.payloadLength,
-                parameters.sampleRateInp,
-                parameters.sampleRateOut,
-                parameters.sampleRate,
-                parameters.samplesPerFrame,
-                parameters.soundMarkerThreshold,
-                parameters.sampleFormatInp,
-                parameters.sampleFormatOut,
-                parameters.operatingMode});
+            g_instances[id] = new GGWave(parameters);
 
             return id;
         }
@@ -142,7 +150,7 @@ int ggwave_decode(
         void * payloadBuffer) {
     GGWave * ggWave = (GGWave *) g_instances[id];
 
-    if (ggWave->decode(waveformBuffer, waveformSize) == false) {
+    if (ggWave->decodeInPlace(waveformBuffer, waveformSize) == false) {
         ggprintf("Failed to decode data - GGWave instance %d\n", id);
         return -1;
     }
@@ -169,7 +177,7 @@ int ggwave_ndecode(
         int payloadSize) {
     GGWave * ggWave = (GGWave *) g_instances[id];
 
-    if (ggWave->decode(waveformBuffer, waveformSize) == false) {
+    if (ggWave->decodeInPlace(waveformBuffer, waveformSize) == false) {
         ggprintf("Failed to decode data - GGWave instance %d\n", id);
         return -1;
     }
@@ -218,12 +226,30 @@ void ggwave_txProtocolSetFreqStart(
     GGWave::Protocols::tx()[protocolId].freqStart = freqStart;
 }
 
+extern "C"
+int ggwave_rxSetPayloadLengths(
+        const int * lengths,
+        int n) {
+    return GGWave::setRxPayloadLengths(lengths, n) ? 1 : 0;
+}
+
 extern "C"
 int ggwave_rxDurationFrames(ggwave_Instance id) {
     GGWave * ggWave = (GGWave *) g_instances[id];
     return ggWave->rxDurationFrames();
 }
 
+extern "C"
+int ggwave_rxAnalyze(ggwave_Instance id) {
+    if (id < 0 || id >= GGWAVE_MAX_INSTANCES || g_instances[id] == nullptr) {
+        ggprintf("Invalid GGWave instance %d\n", id);
+        return -1;
+    }
+
+    GGWave * ggWave = (GGWave *) g_instances[id];
+    return ggWave->rxAnalyze();
+}
+
 //
 // C++ implementation
 //
@@ -248,14 +274,408 @@ uint8_t getDSSMagic(int i) {
 #endif
 }
 
-void FFT(float * f, int N, int * wi, float * wf) {
-    rdft(N, 1, f, wi, wf);
+// number of frames after which the running sum of the spectrum history is recomputed from scratch
+// to get rid of the accumulated floating-point error
+constexpr int kSpectrumHistoryResyncFrames = 64*GGWave::kMaxSpectrumHistory;
+
+// sub-frame resolution of the variable-length analysis search
+constexpr int kAnalysisStepsPerFrame = 16;
+
+// max distance in steps between the estimated start of the data and the offsets that are tried for decoding
+constexpr int kAnalysisSearchRadius = kAnalysisStepsPerFrame;
+
+// hand-over states of the recorded data between decode() and the analysis
+constexpr int kAnalysisIdle    = 0; // decode() owns the recording
+constexpr int kAnalysisPending = 1; // recording complete, waiting for the analysis
+constexpr int kAnalysisRunning = 2;
+constexpr int kAnalysisDone    = 3; // result ready to be delivered by decode()
+
+// access to the hand-over state. Arduino has neither <atomic> nor an analysis thread, so a plain int is enough there
+#ifdef ARDUINO
+int  loadState(const volatile int & state) { return state; }
+void storeState(volatile int & state, int value) { state = value; }
+#else
+int  loadState(const std::atomic<int> & state) { return state.load(std::memory_order_acquire); }
+void storeState(std::atomic<int> & state, int value) { state.store(value, std::memory_order_release); }
+#endif
+
+// hand-over order of two recordings, valid across the wrap-around of the counter
+bool isHandedOverBefore(uint32_t a, uint32_t b) { return int32_t(a - b) < 0; }
+
+// Rx front end limits: shortest decimated frame and longest band-pass filter
+constexpr int kFrontEndMinSamplesPerFrame = 64;
+constexpr int kFrontEndMaxTaps            = 64;
+
+// fixed-length decoding: a frame detects a tone confidently if its bin is at least this many times louder than the
+// other bins of the group. a byte is uncertain unless both nibbles are detected confidently in most frames
+constexpr float kConfidencePeakRatio = 1.5f;
+constexpr uint8_t kToneConfident = 0x80;
+
+// fixed-length decoding: a correction with erasures may change this many bytes more than the nECC/2 of an errors-only
+// correction. each extra byte lets a random word through about 255 times more often
+constexpr int kErasureExtraBytes = 1;
+
+// Rx energy gate: a frame is below the gate if its mean square is within this factor of the noise floor. the
+// floor drops to quieter frames immediately and rises by at most kEnergyGateFloorRise per frame
+constexpr float kEnergyGateThreshold = 2.0f;
+constexpr float kEnergyGateFloorRise = 1.005f;
+constexpr float kEnergyGateMin       = 1e-10f;
+
+// the gate measures the energy in the bins of the Rx protocols, with a band-pass filter of at most this many taps
+// evaluated at about kEnergyGateOutputs positions of the frame
+constexpr int kEnergyGateTaps    = 128;
+constexpr int kEnergyGateOutputs = 128;
+
+int gcd(int a, int b) {
+    while (b != 0) {
+        const int t = a%b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+// dot product with independent partial sums, so that the compiler can vectorize it (n is a multiple of 8)
+inline float dotProduct(const float * a, const float * b, int n) {
+    float sum[8] = { 0.0f };
+    for (int i = 0; i < n; i += 8) {
+        for (int k = 0; k < 8; ++k) {
+            sum[k] += a[i + k]*b[i + k];
+        }
+    }
+
+    return ((sum[0] + sum[1]) + (sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+}
+
+void FFT(const GGWave::FFTBackend & fft, float * f, int N, int * wi, float * wf) {
+    fft.rdft(N, 1, f, wi, wf);
 }
 
-void FFT(const float * src, float * dst, int N, int * wi, float * wf) {
+void FFT(const GGWave::FFTBackend & fft, const float * src, float * dst, int N, int * wi, float * wf) {
     memcpy(dst, src, N * sizeof(float));
 
-    FFT(dst, N, wi, wf);
+    FFT(fft, dst, N, wi, wf);
+}
+
+// power spectrum of the FFT() output in the bins [i0, i1), with the upper half of the bins folded onto the lower one
+void powerSpectrum(const float * fftOut, float * spectrum, int N, int i0, int i1) {
+    for (int i = i0; i < i1; ++i) {
+        spectrum[i] = (fftOut[2*i + 0]*fftOut[2*i + 0] + fftOut[2*i + 1]*fftOut[2*i + 1]);
+    }
+    for (int i = GG_MAX(1, i0); i < GG_MIN(i1, N/2); ++i) {
+        spectrum[i] += spectrum[N - i];
+    }
+}
+
+// FIR filter and decimation by D: dst[i] = sum_j taps[j]*x[i*D + j]
+//
+// x is given split into its D polyphase components: x[i*D + q*D + p] = phases[p*stride + i + q], and the taps
+// in the same order: tap q*D + p is at p*nTapsPhase + q. the outputs are vectorized, the taps are in the inner
+// loop, with four vectors of outputs per iteration to hide the latency of the accumulation
+void filterDecimate(const float * phases, int stride, int D, const float * taps, int nTapsPhase, float * dst, int n) {
+    int i = 0;
+#if defined(GGWAVE_SIMD_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        for (int p = 0; p < D; ++p) {
+            const float * x = phases + p*stride + i;
+            const float * t = taps + p*nTapsPhase;
+            for (int q = 0; q < nTapsPhase; ++q) {
+                const __m128 c = _mm_set1_ps(t[q]);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(c, _mm_loadu_ps(x + q +  0)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(c, _mm_loadu_ps(x + q +  4)));
+                acc2 = _mm_add_ps(acc2, _mm_mul_ps(c, _mm_loadu_ps(x + q +  8)));
+                acc3 = _mm_add_ps(acc3, _mm_mul_ps(c, _mm_loadu_ps(x + q + 12)));
+            }
+        }
+        _mm_storeu_ps(dst + i +  0, acc0);
+        _mm_storeu_ps(dst + i +  4, acc1);
+        _mm_storeu_ps(dst + i +  8, acc2);
+        _mm_storeu_ps(dst + i + 12, acc3);
+    }
+#elif defined(GGWAVE_SIMD_NEON)
+    for (; i + 16 <= n; i += 16) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f);
+        float32x4_t acc3 = vdupq_n_f32(0.0f);
+        for (int p = 0; p < D; ++p) {
+            const float * x = phases + p*stride + i;
+            const float * t = taps + p*nTapsPhase;
+            for (int q = 0; q < nTapsPhase; ++q) {
+                acc0 = vmlaq_n_f32(acc0, vld1q_f32(x + q +  0), t[q]);
+                acc1 = vmlaq_n_f32(acc1, vld1q_f32(x + q +  4), t[q]);
+                acc2 = vmlaq_n_f32(acc2, vld1q_f32(x + q +  8), t[q]);
+                acc3 = vmlaq_n_f32(acc3, vld1q_f32(x + q + 12), t[q]);
+            }
+        }
+        vst1q_f32(dst + i +  0, acc0);
+        vst1q_f32(dst + i +  4, acc1);
+        vst1q_f32(dst + i +  8, acc2);
+        vst1q_f32(dst + i + 12, acc3);
+    }
+#endif
+    for (; i < n; ++i) {
+        float acc = 0.0f;
+        for (int p = 0; p < D; ++p) {
+            for (int q = 0; q < nTapsPhase; ++q) {
+                acc += taps[p*nTapsPhase + q]*phases[p*stride + i + q];
+            }
+        }
+        dst[i] = acc;
+    }
+}
+
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+void filterDecimate_AVX2(const float * phases, int stride, int D, const float * taps, int nTapsPhase, float * dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        for (int p = 0; p < D; ++p) {
+            const float * x = phases + p*stride + i;
+            const float * t = taps + p*nTapsPhase;
+            for (int q = 0; q < nTapsPhase; ++q) {
+                const __m256 c = _mm256_set1_ps(t[q]);
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(c, _mm256_loadu_ps(x + q +  0)));
+                acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(c, _mm256_loadu_ps(x + q +  8)));
+                acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(c, _mm256_loadu_ps(x + q + 16)));
+                acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(c, _mm256_loadu_ps(x + q + 24)));
+            }
+        }
+        _mm256_storeu_ps(dst + i +  0, acc0);
+        _mm256_storeu_ps(dst + i +  8, acc1);
+        _mm256_storeu_ps(dst + i + 16, acc2);
+        _mm256_storeu_ps(dst + i + 24, acc3);
+    }
+
+    filterDecimate(phases + i, stride, D, taps, nTapsPhase, dst + i, n - i);
+}
+#endif
+
+// the front end kernel for this CPU, selected once
+using FilterDecimateKernel = void (*)(const float * phases, int stride, int D, const float * taps, int nTapsPhase, float * dst, int n);
+
+FilterDecimateKernel filterDecimateKernel() {
+    static const FilterDecimateKernel kernel = []() {
+        FilterDecimateKernel res = filterDecimate;
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2")) {
+            res = filterDecimate_AVX2;
+        }
+#endif
+        return res;
+    }();
+
+    return kernel;
+}
+
+// inverse of FFT() without the 2/N scaling
+void IFFT(const GGWave::FFTBackend & fft, float * f, int N, int * wi, float * wf) {
+    fft.rdft(N, -1, f, wi, wf);
+}
+
+// add the tone sin(2*pi*bin*i/N + phase) to a spectrum in the layout of rdft, so that IFFT() produces it
+// bins above N/2 alias to N - bin with negated phase, same as when the tone is sampled directly
+void addToneSpectrum(float * a, int N, int bin, float sinPhase, float cosPhase) {
+    bin %= N;
+    if (2*bin > N) {
+        bin = N - bin;
+        cosPhase = -cosPhase;
+    }
+
+    if (bin == 0) {
+        a[0] += 2.0f*sinPhase;
+    } else if (2*bin == N) {
+        a[1] += 2.0f*sinPhase;
+    } else {
+        a[2*bin + 0] += sinPhase;
+        a[2*bin + 1] += cosPhase;
+    }
+}
+
+// peak-to-second ratio reported by argmax16() when all the other bins are zero
+constexpr float kPeakRatioMax = 1e6f;
+
+inline float peakRatio(float peak, float second) {
+    return peak > second ? (second > 0.0f ? peak/second : kPeakRatioMax) : 1.0f;
+}
+
+#if defined(GGWAVE_SIMD_SSE2)
+inline int hmaxU8(__m128i x) {
+    x = _mm_max_epu8(x, _mm_srli_si128(x, 8));
+    x = _mm_max_epu8(x, _mm_srli_si128(x, 4));
+    x = _mm_max_epu8(x, _mm_srli_si128(x, 2));
+    x = _mm_max_epu8(x, _mm_srli_si128(x, 1));
+    return _mm_cvtsi128_si32(x) & 0xFF;
+}
+
+// horizontal max / min, broadcast to all lanes
+inline __m128 hmaxF32(__m128 x) {
+    x = _mm_max_ps(x, _mm_shuffle_ps(x, x, 0x4E));
+    return _mm_max_ps(x, _mm_shuffle_ps(x, x, 0xB1));
+}
+
+inline __m128 hminF32(__m128 x) {
+    x = _mm_min_ps(x, _mm_shuffle_ps(x, x, 0x4E));
+    return _mm_min_ps(x, _mm_shuffle_ps(x, x, 0xB1));
+}
+#elif defined(GGWAVE_SIMD_NEON)
+inline int hmaxU8(uint8x16_t x) {
+    uint8x8_t m = vpmax_u8(vget_low_u8(x), vget_high_u8(x));
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    return vget_lane_u8(m, 0);
+}
+
+inline float hmaxF32(float32x4_t x) {
+    float32x2_t m = vpmax_f32(vget_low_f32(x), vget_high_f32(x));
+    return vget_lane_f32(vpmax_f32(m, m), 0);
+}
+
+inline float hminF32(float32x4_t x) {
+    float32x2_t m = vpmin_f32(vget_low_f32(x), vget_high_f32(x));
+    return vget_lane_f32(vpmin_f32(m, m), 0);
+}
+#endif
+
+// index of the largest of 16 tone bins and its ratio to the largest of the other bins (1 on ties). the quantized
+// version returns the last of equal maxima, as the fixed-length votes always did, the float version the first one,
+// as the variable-length decoder. the float bins must be non-negative
+inline int argmax16(const uint8_t * v, float & ratio) {
+#if defined(GGWAVE_SIMD_SSE2)
+    const __m128i idx = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i x   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v));
+
+    const int peak   = hmaxU8(x);
+    const int res    = hmaxU8(_mm_and_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8((char) peak)), idx));
+    const int second = hmaxU8(_mm_andnot_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8((char) res)), x));
+#elif defined(GGWAVE_SIMD_NEON)
+    static const uint8_t kIdx[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    const uint8x16_t idx = vld1q_u8(kIdx);
+    const uint8x16_t x   = vld1q_u8(v);
+
+    const int peak   = hmaxU8(x);
+    const int res    = hmaxU8(vandq_u8(vceqq_u8(x, vdupq_n_u8(peak)), idx));
+    const int second = hmaxU8(vbicq_u8(x, vceqq_u8(idx, vdupq_n_u8(res))));
+#else
+    int res = 0;
+    int peak = v[0];
+
+    int second = 0;
+    for (int b = 1; b < 16; ++b) {
+        if (peak <= v[b]) {
+            second = peak;
+            peak = v[b];
+            res = b;
+        } else if (second < v[b]) {
+            second = v[b];
+        }
+    }
+#endif
+
+    ratio = ::peakRatio(peak, second);
+
+    return res;
+}
+
+inline int argmax16(const float * v, float & ratio) {
+#if defined(GGWAVE_SIMD_SSE2)
+    const __m128 x0 = _mm_loadu_ps(v +  0);
+    const __m128 x1 = _mm_loadu_ps(v +  4);
+    const __m128 x2 = _mm_loadu_ps(v +  8);
+    const __m128 x3 = _mm_loadu_ps(v + 12);
+
+    const __m128 peak = hmaxF32(_mm_max_ps(_mm_max_ps(x0, x1), _mm_max_ps(x2, x3)));
+
+    // the smallest index of the lanes equal to the peak, 16 for the others
+    const __m128 none = _mm_set1_ps(16.0f);
+    const __m128 idx0 = _mm_setr_ps( 0.0f,  1.0f,  2.0f,  3.0f);
+    const __m128 idx1 = _mm_setr_ps( 4.0f,  5.0f,  6.0f,  7.0f);
+    const __m128 idx2 = _mm_setr_ps( 8.0f,  9.0f, 10.0f, 11.0f);
+    const __m128 idx3 = _mm_setr_ps(12.0f, 13.0f, 14.0f, 15.0f);
+
+    auto select = [&](__m128 x, __m128 idx) {
+        const __m128 eq = _mm_cmpeq_ps(x, peak);
+        return _mm_or_ps(_mm_and_ps(eq, idx), _mm_andnot_ps(eq, none));
+    };
+
+    const __m128 res = hminF32(_mm_min_ps(_mm_min_ps(select(x0, idx0), select(x1, idx1)),
+                                          _mm_min_ps(select(x2, idx2), select(x3, idx3))));
+
+    const __m128 second = hmaxF32(_mm_max_ps(
+            _mm_max_ps(_mm_andnot_ps(_mm_cmpeq_ps(idx0, res), x0), _mm_andnot_ps(_mm_cmpeq_ps(idx1, res), x1)),
+            _mm_max_ps(_mm_andnot_ps(_mm_cmpeq_ps(idx2, res), x2), _mm_andnot_ps(_mm_cmpeq_ps(idx3, res), x3))));
+
+    ratio = ::peakRatio(_mm_cvtss_f32(peak), _mm_cvtss_f32(second));
+
+    return (int) _mm_cvtss_f32(res);
+#elif defined(GGWAVE_SIMD_NEON)
+    static const float kIdx[16] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f };
+
+    const float32x4_t x0 = vld1q_f32(v +  0);
+    const float32x4_t x1 = vld1q_f32(v +  4);
+    const float32x4_t x2 = vld1q_f32(v +  8);
+    const float32x4_t x3 = vld1q_f32(v + 12);
+
+    const float32x4_t idx0 = vld1q_f32(kIdx +  0);
+    const float32x4_t idx1 = vld1q_f32(kIdx +  4);
+    const float32x4_t idx2 = vld1q_f32(kIdx +  8);
+    const float32x4_t idx3 = vld1q_f32(kIdx + 12);
+
+    const float peak = hmaxF32(vmaxq_f32(vmaxq_f32(x0, x1), vmaxq_f32(x2, x3)));
+
+    // the smallest index of the lanes equal to the peak, 16 for the others
+    const float32x4_t vpeak = vdupq_n_f32(peak);
+    const float32x4_t none  = vdupq_n_f32(16.0f);
+
+    const float res = hminF32(vminq_f32(
+            vminq_f32(vbslq_f32(vceqq_f32(x0, vpeak), idx0, none), vbslq_f32(vceqq_f32(x1, vpeak), idx1, none)),
+            vminq_f32(vbslq_f32(vceqq_f32(x2, vpeak), idx2, none), vbslq_f32(vceqq_f32(x3, vpeak), idx3, none))));
+
+    const float32x4_t vres = vdupq_n_f32(res);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    const float second = hmaxF32(vmaxq_f32(
+            vmaxq_f32(vbslq_f32(vceqq_f32(idx0, vres), zero, x0), vbslq_f32(vceqq_f32(idx1, vres), zero, x1)),
+            vmaxq_f32(vbslq_f32(vceqq_f32(idx2, vres), zero, x2), vbslq_f32(vceqq_f32(idx3, vres), zero, x3))));
+
+    ratio = ::peakRatio(peak, second);
+
+    return (int) res;
+#else
+    int res = 0;
+    float peak = v[0];
+
+    float second = 0.0f;
+    for (int b = 1; b < 16; ++b) {
+        if (peak < v[b]) {
+            second = peak;
+            peak = v[b];
+            res = b;
+        } else if (second < v[b]) {
+            second = v[b];
+        }
+    }
+
+    ratio = ::peakRatio(peak, second);
+
+    return res;
+#endif
+}
+
+// first bin of tone group g of a protocol. the nibbles of byte j are in the groups 2*j and 2*j + 1. the mono-tone
+// protocols send them in consecutive Txs in group 2*j
+inline int groupBin(const GGWave::Protocol & protocol, int g) {
+    return protocol.freqStart + (protocol.extra == 1 ? g : 2*g)*16;
 }
 
 inline void addAmplitudeSmooth(
@@ -281,110 +701,781 @@ inline void addAmplitudeSmooth(
     }
 }
 
-int getECCBytesForLength(int len) {
-    // return len < 4 ? 2 : GG_MAX(4, 2*(len/5));
-     return GG_MAX(8,len / 4); // 将ECC字节从默认4字节增加到8字节或长度的1/4
-}
-
-int bytesForSampleFormat(GGWave::SampleFormat sampleFormat) {
-    switch (sampleFormat) {
-        case GGWAVE_SAMPLE_FORMAT_UNDEFINED:    return 0;                   break;
-        case GGWAVE_SAMPLE_FORMAT_U8:           return sizeof(uint8_t);     break;
-        case GGWAVE_SAMPLE_FORMAT_I8:           return sizeof(int8_t);      break;
-        case GGWAVE_SAMPLE_FORMAT_U16:          return sizeof(uint16_t);    break;
-        case GGWAVE_SAMPLE_FORMAT_I16:          return sizeof(int16_t);     break;
-        case GGWAVE_SAMPLE_FORMAT_F32:          return sizeof(float);       break;
-    };
-
-    ggprintf("Invalid sample format: %d\n", (int) sampleFormat);
+// 16-bit samples <-> floats in the range [-1, 1]. the 16-bit buffers do not need to be aligned
+// flip = 0x8000 converts unsigned samples by flipping the sign bit. floats out of range saturate
+inline float i16ToF32(const uint8_t * src, uint16_t flip) {
+    uint16_t v;
+    memcpy(&v, src, sizeof(v));
 
-    return 0;
+    return float(int16_t(v ^ flip))*(1.0f/32768);
 }
 
+inline void f32ToI16(float src, uint8_t * dst) {
+    int32_t v = 32768*src;
+    v = GG_MAX(-32768, GG_MIN(32767, v));
+
+    const int16_t r = v;
+    memcpy(dst, &r, sizeof(r));
 }
 
-//
-// ggvector
-//
+void convertI16ToF32(const void * src, float * dst, int n, uint16_t flip) {
+    auto p = reinterpret_cast<const uint8_t *>(src);
 
-template<typename T>
-void ggvector<T>::assign(const ggvector & other) {
-    m_data = other.m_data;
-    m_size = other.m_size;
+    int i = 0;
+#if defined(GGWAVE_SIMD_SSE2)
+    const __m128i vflip  = _mm_set1_epi16(flip);
+    const __m128  vscale = _mm_set1_ps(1.0f/32768);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i v  = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2*i)), vflip);
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#elif defined(GGWAVE_SIMD_NEON)
+    const uint16x8_t vflip = vdupq_n_u16(flip);
+    for (; i + 8 <= n; i += 8) {
+        const int16x8_t v = vreinterpretq_s16_u16(veorq_u16(vreinterpretq_u16_u8(vld1q_u8(p + 2*i)), vflip));
+        vst1q_f32(dst + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))),  1.0f/32768));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f/32768));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = i16ToF32(p + 2*i, flip);
+    }
 }
 
-template<typename T>
-void ggvector<T>::copy(const ggvector & other) {
-    if (this == &other) {
-        assert(false);
-    }
+void convertF32ToI16(const float * src, void * dst, int n) {
+    auto p = reinterpret_cast<uint8_t *>(dst);
 
-    memcpy(m_data, other.m_data, GG_MIN(m_size, other.m_size)*sizeof(T));
+    int i = 0;
+#if defined(GGWAVE_SIMD_SSE2)
+    const __m128 vscale = _mm_set1_ps(32768.0f);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 0), vscale));
+        const __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), vscale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 2*i), _mm_packs_epi32(a, b));
+    }
+#elif defined(GGWAVE_SIMD_NEON)
+    for (; i + 8 <= n; i += 8) {
+        const int32x4_t a = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 0), 32768.0f));
+        const int32x4_t b = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f));
+        vst1q_u8(p + 2*i, vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b))));
+    }
+#endif
+    for (; i < n; ++i) {
+        f32ToI16(src[i], p + 2*i);
+    }
 }
 
-template<typename T>
-void ggvector<T>::zero() {
-    memset(m_data, 0, m_size*sizeof(T));
-}
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+void convertI16ToF32_AVX2(const void * src, float * dst, int n, uint16_t flip) {
+    auto p = reinterpret_cast<const uint8_t *>(src);
 
-template<typename T>
-void ggvector<T>::zero(int n) {
-    memset(m_data, 0, n*sizeof(T));
+    const __m128i vflip  = _mm_set1_epi16(flip);
+    const __m256  vscale = _mm256_set1_ps(1.0f/32768);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2*i + 0)),  vflip);
+        const __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2*i + 16)), vflip);
+        _mm256_storeu_ps(dst + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), vscale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), vscale));
+    }
+    for (; i < n; ++i) {
+        dst[i] = i16ToF32(p + 2*i, flip);
+    }
 }
 
-template struct ggvector<int16_t>;
+__attribute__((target("avx2")))
+void convertF32ToI16_AVX2(const float * src, void * dst, int n) {
+    auto p = reinterpret_cast<uint8_t *>(dst);
 
-//
-// ggmatrix
-//
+    const __m256 vscale = _mm256_set1_ps(32768.0f);
 
-template <typename T>
-void ggmatrix<T>::zero() {
-    if (m_size0 > 0 && m_size1 > 0) {
-        memset(m_data, 0, m_size0*m_size1*sizeof(T));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i a = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 0), vscale));
+        const __m256i b = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), vscale));
+        // packs works within 128-bit lanes, so the 64-bit quarters are reordered afterwards
+        const __m256i r = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p + 2*i), r);
+    }
+    for (; i < n; ++i) {
+        f32ToI16(src[i], p + 2*i);
     }
 }
+#endif
 
-//
-// Protocols
-//
+// the 16-bit conversion kernels for this CPU, selected once
+struct SampleKernels {
+    void (*i16ToF32)(const void * src, float * dst, int n, uint16_t flip);
+    void (*f32ToI16)(const float * src, void * dst, int n);
+};
 
-void GGWave::Protocols::enableAll() {
-    for (int i = 0; i < GGWAVE_PROTOCOL_COUNT; i++) {
-        auto & p = this->data[i];
-        if (p.name) {
-            p.enabled = true;
+const SampleKernels & sampleKernels() {
+    static const SampleKernels kernels = []() {
+        SampleKernels res = { convertI16ToF32, convertF32ToI16 };
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2")) {
+            res = { convertI16ToF32_AVX2, convertF32ToI16_AVX2 };
         }
-    }
+#endif
+        return res;
+    }();
+
+    return kernels;
 }
 
-void GGWave::Protocols::disableAll() {
-    for (int i = 0; i < GGWAVE_PROTOCOL_COUNT; i++) {
-        auto & p = this->data[i];
-        p.enabled = false;
+// convert samples of the given input format to floats in the range [-1, 1]. src does not need to be aligned
+void convertInput(const void * src, float * dst, int n, GGWave::SampleFormat format) {
+    switch (format) {
+        case GGWAVE_SAMPLE_FORMAT_UNDEFINED: break;
+        case GGWAVE_SAMPLE_FORMAT_U8:
+            {
+                constexpr float scale = 1.0f/128;
+                auto p = reinterpret_cast<const uint8_t *>(src);
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = float(int16_t(p[i]) - 128)*scale;
+                }
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_I8:
+            {
+                constexpr float scale = 1.0f/128;
+                auto p = reinterpret_cast<const int8_t *>(src);
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = float(p[i])*scale;
+                }
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_U16:
+            {
+                ::sampleKernels().i16ToF32(src, dst, n, 0x8000);
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_I16:
+            {
+                ::sampleKernels().i16ToF32(src, dst, n, 0);
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_F32:
+            {
+                memcpy(dst, src, n*sizeof(float));
+            } break;
     }
 }
 
-void GGWave::Protocols::toggle(ProtocolId id, bool state) {
-    if (state) {
-        // enable protocol
-        data[id].enabled = true;
-    } else {
-        // disable protocol
-        data[id].enabled = false;
+// convert samples in the range [-1, 1] to the given output format
+void convertOutput(const float * src, void * dst, int n, GGWave::SampleFormat format) {
+    switch (format) {
+        case GGWAVE_SAMPLE_FORMAT_UNDEFINED: break;
+        case GGWAVE_SAMPLE_FORMAT_U8:
+            {
+                auto p = reinterpret_cast<uint8_t *>(dst);
+                for (int i = 0; i < n; ++i) {
+                    p[i] = 128*(src[i] + 1.0f);
+                }
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_I8:
+            {
+                auto p = reinterpret_cast<uint8_t *>(dst);
+                for (int i = 0; i < n; ++i) {
+                    p[i] = 128*src[i];
+                }
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_U16:
+            {
+                auto p = reinterpret_cast<uint16_t *>(dst);
+                for (int i = 0; i < n; ++i) {
+                    p[i] = 32768*(src[i] + 1.0f);
+                }
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_I16:
+            {
+                ::sampleKernels().f32ToI16(src, dst, n);
+            } break;
+        case GGWAVE_SAMPLE_FORMAT_F32:
+            {
+                memcpy(dst, src, n*sizeof(float));
+            } break;
     }
 }
 
-void GGWave::Protocols::only(ProtocolId id) {
-    disableAll();
-    data[id].enabled = true;
-}
+//
+// Vectorized real FFT
+//
+// The N-point real transform is an N/2-point complex FFT of the even/odd samples, followed by the split step
+// that separates the two spectra. The complex FFT is a Stockham radix-4 FFT (with a final radix-2 stage
+// when needed) on split real/imaginary arrays, so it needs no bit reversal. Each stage is vectorized over
+// the contiguous runs of its stride, except for the first one, which is vectorized over the butterflies.
+//
 
-GGWave::TxProtocols & GGWave::Protocols::tx() {
-    static TxProtocols protocols = kDefault();
+#if defined(GGWAVE_SIMD_SSE2) || defined(GGWAVE_SIMD_NEON)
+// smaller transforms are done with rdft()
+constexpr int kFFTMinSizeSIMD = 64;
 
-    return protocols;
-}
+// float work buffer of the vectorized FFT, for N = 2*M
+struct FFTLayout {
+    int M;
+
+    // W^p, W^2p, W^3p for p < M/4, W = exp(-2*pi*i/M)
+    float * w1r; float * w1i;
+    float * w2r; float * w2i;
+    float * w3r; float * w3i;
+
+    // split step twiddles exp(-2*pi*i*k/N) for k <= M/2
+    float * cr; float * ci;
+
+    // ping-pong buffers of the complex FFT
+    float * xr; float * xi;
+    float * yr; float * yi;
+
+    FFTLayout(int N, float * wf) : M(N/2) {
+        w1r = wf; w1i = w1r + M/4;
+        w2r = w1i + M/4; w2i = w2r + M/4;
+        w3r = w2i + M/4; w3i = w3r + M/4;
+        cr  = w3i + M/4; ci  = cr + M/2 + 1;
+        xr  = ci + M/2 + 1; xi = xr + M;
+        yr  = xi + M; yi = yr + M;
+    }
+
+    static int size(int N) { return 13*(N/4) + 2; }
+};
+
+// stage kernels of the complex FFT for one vector width
+struct FFTKernels {
+    int lanes;
+
+    // first radix-4 stage (n = M, s = 1)
+    void (*radix4First)(const FFTLayout & L, const float * xr, const float * xi, float * yr, float * yi);
+    // radix-4 stage of length n and stride s >= lanes
+    void (*radix4)(const FFTLayout & L, int n, int s, const float * xr, const float * xi, float * yr, float * yi);
+    // final radix-2 stage (n = 2, s = M/2)
+    void (*radix2)(int s, const float * xr, const float * xi, float * yr, float * yi);
+};
+
+#if defined(GGWAVE_SIMD_SSE2)
+using f4 = __m128;
+inline f4   f4load (const float * p)   { return _mm_loadu_ps(p); }
+inline void f4store(float * p, f4 v)   { _mm_storeu_ps(p, v); }
+inline f4   f4set1 (float v)           { return _mm_set1_ps(v); }
+inline f4   f4add  (f4 a, f4 b)        { return _mm_add_ps(a, b); }
+inline f4   f4sub  (f4 a, f4 b)        { return _mm_sub_ps(a, b); }
+inline f4   f4mul  (f4 a, f4 b)        { return _mm_mul_ps(a, b); }
+
+// store a0 b0 c0 d0 a1 b1 c1 d1 ...
+inline void f4storeInterleaved(float * p, f4 a, f4 b, f4 c, f4 d) {
+    const f4 t0 = _mm_unpacklo_ps(a, c);
+    const f4 t1 = _mm_unpackhi_ps(a, c);
+    const f4 t2 = _mm_unpacklo_ps(b, d);
+    const f4 t3 = _mm_unpackhi_ps(b, d);
+    _mm_storeu_ps(p + 0,  _mm_unpacklo_ps(t0, t2));
+    _mm_storeu_ps(p + 4,  _mm_unpackhi_ps(t0, t2));
+    _mm_storeu_ps(p + 8,  _mm_unpacklo_ps(t1, t3));
+    _mm_storeu_ps(p + 12, _mm_unpackhi_ps(t1, t3));
+}
+
+// store a0 b0 a1 b1 ...
+inline void f4storeInterleaved(float * p, f4 a, f4 b) {
+    _mm_storeu_ps(p + 0, _mm_unpacklo_ps(a, b));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a, b));
+}
+
+// load a0 b0 a1 b1 ...
+inline void f4loadDeinterleaved(const float * p, f4 & a, f4 & b) {
+    const f4 lo = _mm_loadu_ps(p + 0);
+    const f4 hi = _mm_loadu_ps(p + 4);
+    a = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+    b = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline f4 f4reverse(f4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)); }
+#else
+using f4 = float32x4_t;
+inline f4   f4load (const float * p)   { return vld1q_f32(p); }
+inline void f4store(float * p, f4 v)   { vst1q_f32(p, v); }
+inline f4   f4set1 (float v)           { return vdupq_n_f32(v); }
+inline f4   f4add  (f4 a, f4 b)        { return vaddq_f32(a, b); }
+inline f4   f4sub  (f4 a, f4 b)        { return vsubq_f32(a, b); }
+inline f4   f4mul  (f4 a, f4 b)        { return vmulq_f32(a, b); }
+
+inline void f4storeInterleaved(float * p, f4 a, f4 b, f4 c, f4 d) {
+    const float32x4x4_t v = { { a, b, c, d } };
+    vst4q_f32(p, v);
+}
+
+inline void f4storeInterleaved(float * p, f4 a, f4 b) {
+    const float32x4x2_t v = { { a, b } };
+    vst2q_f32(p, v);
+}
+
+inline void f4loadDeinterleaved(const float * p, f4 & a, f4 & b) {
+    const float32x4x2_t v = vld2q_f32(p);
+    a = v.val[0];
+    b = v.val[1];
+}
+
+inline f4 f4reverse(f4 v) {
+    v = vrev64q_f32(v);
+    return vcombine_f32(vget_high_f32(v), vget_low_f32(v));
+}
+#endif
+
+// radix-4 butterfly: y0 = a + b + c + d, y1 = w1*(a - jb - c + jd), y2 = w2*(a - b + c - d), y3 = w3*(a + jb - c - jd)
+inline void fftButterfly4(
+        f4 ar, f4 ai, f4 br, f4 bi, f4 cr, f4 ci, f4 dr, f4 di,
+        f4 w1r, f4 w1i, f4 w2r, f4 w2i, f4 w3r, f4 w3i, f4 * yr, f4 * yi) {
+    const f4 apcr = f4add(ar, cr), apci = f4add(ai, ci);
+    const f4 amcr = f4sub(ar, cr), amci = f4sub(ai, ci);
+    const f4 bpdr = f4add(br, dr), bpdi = f4add(bi, di);
+    const f4 bmdr = f4sub(br, dr), bmdi = f4sub(bi, di);
+
+    const f4 t1r = f4add(amcr, bmdi), t1i = f4sub(amci, bmdr);
+    const f4 t2r = f4sub(apcr, bpdr), t2i = f4sub(apci, bpdi);
+    const f4 t3r = f4sub(amcr, bmdi), t3i = f4add(amci, bmdr);
+
+    yr[0] = f4add(apcr, bpdr);
+    yi[0] = f4add(apci, bpdi);
+    yr[1] = f4sub(f4mul(w1r, t1r), f4mul(w1i, t1i));
+    yi[1] = f4add(f4mul(w1r, t1i), f4mul(w1i, t1r));
+    yr[2] = f4sub(f4mul(w2r, t2r), f4mul(w2i, t2i));
+    yi[2] = f4add(f4mul(w2r, t2i), f4mul(w2i, t2r));
+    yr[3] = f4sub(f4mul(w3r, t3r), f4mul(w3i, t3i));
+    yi[3] = f4add(f4mul(w3r, t3i), f4mul(w3i, t3r));
+}
+
+void fftRadix4First(const FFTLayout & L, const float * xr, const float * xi, float * yr, float * yi) {
+    const int m = L.M/4;
+    for (int p = 0; p < m; p += 4) {
+        f4 vr[4], vi[4];
+        fftButterfly4(
+                f4load(xr + p),       f4load(xi + p),       f4load(xr + p + m),   f4load(xi + p + m),
+                f4load(xr + p + 2*m), f4load(xi + p + 2*m), f4load(xr + p + 3*m), f4load(xi + p + 3*m),
+                f4load(L.w1r + p), f4load(L.w1i + p), f4load(L.w2r + p), f4load(L.w2i + p), f4load(L.w3r + p), f4load(L.w3i + p),
+                vr, vi);
+        f4storeInterleaved(yr + 4*p, vr[0], vr[1], vr[2], vr[3]);
+        f4storeInterleaved(yi + 4*p, vi[0], vi[1], vi[2], vi[3]);
+    }
+}
+
+void fftRadix4(const FFTLayout & L, int n, int s, const float * xr, const float * xi, float * yr, float * yi) {
+    const int m = n/4;
+    for (int p = 0; p < m; ++p) {
+        const f4 w1r = f4set1(L.w1r[p*s]), w1i = f4set1(L.w1i[p*s]);
+        const f4 w2r = f4set1(L.w2r[p*s]), w2i = f4set1(L.w2i[p*s]);
+        const f4 w3r = f4set1(L.w3r[p*s]), w3i = f4set1(L.w3i[p*s]);
+
+        const float * ar = xr + s*p; const float * ai = xi + s*p;
+        float * or_ = yr + 4*s*p; float * oi = yi + 4*s*p;
+        for (int q = 0; q < s; q += 4) {
+            f4 vr[4], vi[4];
+            fftButterfly4(
+                    f4load(ar + q),       f4load(ai + q),       f4load(ar + q + s*m),   f4load(ai + q + s*m),
+                    f4load(ar + q + 2*s*m), f4load(ai + q + 2*s*m), f4load(ar + q + 3*s*m), f4load(ai + q + 3*s*m),
+                    w1r, w1i, w2r, w2i, w3r, w3i, vr, vi);
+            for (int k = 0; k < 4; ++k) {
+                f4store(or_ + q + k*s, vr[k]);
+                f4store(oi  + q + k*s, vi[k]);
+            }
+        }
+    }
+}
+
+void fftRadix2(int s, const float * xr, const float * xi, float * yr, float * yi) {
+    for (int q = 0; q < s; q += 4) {
+        const f4 ar = f4load(xr + q), ai = f4load(xi + q);
+        const f4 br = f4load(xr + q + s), bi = f4load(xi + q + s);
+        f4store(yr + q, f4add(ar, br)); f4store(yr + q + s, f4sub(ar, br));
+        f4store(yi + q, f4add(ai, bi)); f4store(yi + q + s, f4sub(ai, bi));
+    }
+}
+
+const FFTKernels kFFTKernels = { 4, fftRadix4First, fftRadix4, fftRadix2 };
+
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+inline void fftButterfly4_AVX2(
+        __m256 ar, __m256 ai, __m256 br, __m256 bi, __m256 cr, __m256 ci, __m256 dr, __m256 di,
+        __m256 w1r, __m256 w1i, __m256 w2r, __m256 w2i, __m256 w3r, __m256 w3i, __m256 * yr, __m256 * yi) {
+    const __m256 apcr = _mm256_add_ps(ar, cr), apci = _mm256_add_ps(ai, ci);
+    const __m256 amcr = _mm256_sub_ps(ar, cr), amci = _mm256_sub_ps(ai, ci);
+    const __m256 bpdr = _mm256_add_ps(br, dr), bpdi = _mm256_add_ps(bi, di);
+    const __m256 bmdr = _mm256_sub_ps(br, dr), bmdi = _mm256_sub_ps(bi, di);
+
+    const __m256 t1r = _mm256_add_ps(amcr, bmdi), t1i = _mm256_sub_ps(amci, bmdr);
+    const __m256 t2r = _mm256_sub_ps(apcr, bpdr), t2i = _mm256_sub_ps(apci, bpdi);
+    const __m256 t3r = _mm256_sub_ps(amcr, bmdi), t3i = _mm256_add_ps(amci, bmdr);
+
+    yr[0] = _mm256_add_ps(apcr, bpdr);
+    yi[0] = _mm256_add_ps(apci, bpdi);
+    yr[1] = _mm256_sub_ps(_mm256_mul_ps(w1r, t1r), _mm256_mul_ps(w1i, t1i));
+    yi[1] = _mm256_add_ps(_mm256_mul_ps(w1r, t1i), _mm256_mul_ps(w1i, t1r));
+    yr[2] = _mm256_sub_ps(_mm256_mul_ps(w2r, t2r), _mm256_mul_ps(w2i, t2i));
+    yi[2] = _mm256_add_ps(_mm256_mul_ps(w2r, t2i), _mm256_mul_ps(w2i, t2r));
+    yr[3] = _mm256_sub_ps(_mm256_mul_ps(w3r, t3r), _mm256_mul_ps(w3i, t3i));
+    yi[3] = _mm256_add_ps(_mm256_mul_ps(w3r, t3i), _mm256_mul_ps(w3i, t3r));
+}
+
+// store a0 b0 c0 d0 a1 b1 c1 d1 ... - unpack works within 128-bit lanes, so the lanes are reordered afterwards
+__attribute__((target("avx2")))
+inline void fftStoreInterleaved_AVX2(float * p, __m256 a, __m256 b, __m256 c, __m256 d) {
+    const __m256 t0 = _mm256_unpacklo_ps(a, c);
+    const __m256 t1 = _mm256_unpackhi_ps(a, c);
+    const __m256 t2 = _mm256_unpacklo_ps(b, d);
+    const __m256 t3 = _mm256_unpackhi_ps(b, d);
+    const __m256 u0 = _mm256_unpacklo_ps(t0, t2);
+    const __m256 u1 = _mm256_unpackhi_ps(t0, t2);
+    const __m256 u2 = _mm256_unpacklo_ps(t1, t3);
+    const __m256 u3 = _mm256_unpackhi_ps(t1, t3);
+    _mm256_storeu_ps(p + 0,  _mm256_permute2f128_ps(u0, u1, 0x20));
+    _mm256_storeu_ps(p + 8,  _mm256_permute2f128_ps(u2, u3, 0x20));
+    _mm256_storeu_ps(p + 16, _mm256_permute2f128_ps(u0, u1, 0x31));
+    _mm256_storeu_ps(p + 24, _mm256_permute2f128_ps(u2, u3, 0x31));
+}
+
+__attribute__((target("avx2")))
+void fftRadix4First_AVX2(const FFTLayout & L, const float * xr, const float * xi, float * yr, float * yi) {
+    const int m = L.M/4;
+    for (int p = 0; p < m; p += 8) {
+        __m256 vr[4], vi[4];
+        fftButterfly4_AVX2(
+                _mm256_loadu_ps(xr + p),       _mm256_loadu_ps(xi + p),
+                _mm256_loadu_ps(xr + p + m),   _mm256_loadu_ps(xi + p + m),
+                _mm256_loadu_ps(xr + p + 2*m), _mm256_loadu_ps(xi + p + 2*m),
+                _mm256_loadu_ps(xr + p + 3*m), _mm256_loadu_ps(xi + p + 3*m),
+                _mm256_loadu_ps(L.w1r + p), _mm256_loadu_ps(L.w1i + p),
+                _mm256_loadu_ps(L.w2r + p), _mm256_loadu_ps(L.w2i + p),
+                _mm256_loadu_ps(L.w3r + p), _mm256_loadu_ps(L.w3i + p),
+                vr, vi);
+        fftStoreInterleaved_AVX2(yr + 4*p, vr[0], vr[1], vr[2], vr[3]);
+        fftStoreInterleaved_AVX2(yi + 4*p, vi[0], vi[1], vi[2], vi[3]);
+    }
+}
+
+__attribute__((target("avx2")))
+void fftRadix4_AVX2(const FFTLayout & L, int n, int s, const float * xr, const float * xi, float * yr, float * yi) {
+    const int m = n/4;
+    for (int p = 0; p < m; ++p) {
+        const __m256 w1r = _mm256_set1_ps(L.w1r[p*s]), w1i = _mm256_set1_ps(L.w1i[p*s]);
+        const __m256 w2r = _mm256_set1_ps(L.w2r[p*s]), w2i = _mm256_set1_ps(L.w2i[p*s]);
+        const __m256 w3r = _mm256_set1_ps(L.w3r[p*s]), w3i = _mm256_set1_ps(L.w3i[p*s]);
+
+        const float * ar = xr + s*p; const float * ai = xi + s*p;
+        float * or_ = yr + 4*s*p; float * oi = yi + 4*s*p;
+        for (int q = 0; q < s; q += 8) {
+            __m256 vr[4], vi[4];
+            fftButterfly4_AVX2(
+                    _mm256_loadu_ps(ar + q),         _mm256_loadu_ps(ai + q),
+                    _mm256_loadu_ps(ar + q + s*m),   _mm256_loadu_ps(ai + q + s*m),
+                    _mm256_loadu_ps(ar + q + 2*s*m), _mm256_loadu_ps(ai + q + 2*s*m),
+                    _mm256_loadu_ps(ar + q + 3*s*m), _mm256_loadu_ps(ai + q + 3*s*m),
+                    w1r, w1i, w2r, w2i, w3r, w3i, vr, vi);
+            for (int k = 0; k < 4; ++k) {
+                _mm256_storeu_ps(or_ + q + k*s, vr[k]);
+                _mm256_storeu_ps(oi  + q + k*s, vi[k]);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void fftRadix2_AVX2(int s, const float * xr, const float * xi, float * yr, float * yi) {
+    for (int q = 0; q < s; q += 8) {
+        const __m256 ar = _mm256_loadu_ps(xr + q), ai = _mm256_loadu_ps(xi + q);
+        const __m256 br = _mm256_loadu_ps(xr + q + s), bi = _mm256_loadu_ps(xi + q + s);
+        _mm256_storeu_ps(yr + q, _mm256_add_ps(ar, br)); _mm256_storeu_ps(yr + q + s, _mm256_sub_ps(ar, br));
+        _mm256_storeu_ps(yi + q, _mm256_add_ps(ai, bi)); _mm256_storeu_ps(yi + q + s, _mm256_sub_ps(ai, bi));
+    }
+}
+
+const FFTKernels kFFTKernelsAVX2 = { 8, fftRadix4First_AVX2, fftRadix4_AVX2, fftRadix2_AVX2 };
+#endif
+
+void fftInitSIMD(int N, int * wi, float * wf) {
+    const FFTLayout L(N, wf);
+    const int M = L.M;
+
+    for (int p = 0; p < M/4; ++p) {
+        const double phi = 2.0*M_PI*p/M;
+        L.w1r[p] = cos(1*phi); L.w1i[p] = -sin(1*phi);
+        L.w2r[p] = cos(2*phi); L.w2i[p] = -sin(2*phi);
+        L.w3r[p] = cos(3*phi); L.w3i[p] = -sin(3*phi);
+    }
+
+    for (int k = 0; k <= M/2; ++k) {
+        const double phi = 2.0*M_PI*k/N;
+        L.cr[k] = cos(phi); L.ci[k] = -sin(phi);
+    }
+
+    wi[0] = N;
+}
+
+// rdft() with the complex FFT done by the given stage kernels. stages with a stride shorter than the
+// vector width of "wide" use the kernels of "base"
+void rdftSIMD(int N, int isgn, float * a, int * wi, float * wf, const FFTKernels & wide, const FFTKernels & base) {
+    if (N < kFFTMinSizeSIMD) {
+        rdft(N, isgn, a, wi, wf);
+        return;
+    }
+
+    if (wi[0] != N) {
+        fftInitSIMD(N, wi, wf);
+    }
+
+    const FFTLayout L(N, wf);
+    const int M = L.M;
+
+    const f4 half = f4set1(0.5f);
+    const f4 zero = f4set1(0.0f);
+
+    if (isgn >= 0) {
+        for (int n = 0; n < M; n += 4) {
+            f4 re, im;
+            f4loadDeinterleaved(a + 2*n, re, im);
+            f4store(L.xr + n, re);
+            f4store(L.xi + n, im);
+        }
+    } else {
+        // undo the split step and conjugate, so that the forward FFT below computes the inverse one
+        L.xr[0] = 0.5f*(a[0] + a[1]);
+        L.xi[0] = 0.5f*(a[1] - a[0]);
+
+        // k and M - k at once, the M - k vectors are reversed
+        int k = 1;
+        for (; k + 4 <= M/2; k += 4) {
+            f4 xkr, xki, xmr, xmi;
+            f4loadDeinterleaved(a + 2*k, xkr, xki);
+            f4loadDeinterleaved(a + 2*(M - k - 3), xmr, xmi);
+            xki = f4sub(zero, xki);
+            xmr = f4reverse(xmr);
+            xmi = f4reverse(xmi);
+
+            const f4 cr = f4load(L.cr + k), ci = f4load(L.ci + k);
+
+            const f4 er = f4mul(half, f4add(xkr, xmr)), ei = f4mul(half, f4add(xki, xmi));
+            const f4 dr = f4mul(half, f4sub(xkr, xmr)), di = f4mul(half, f4sub(xki, xmi));
+            const f4 or_ = f4add(f4mul(dr, cr), f4mul(di, ci));
+            const f4 oi  = f4sub(f4mul(di, cr), f4mul(dr, ci));
+
+            f4store(L.xr + k, f4sub(er, oi));
+            f4store(L.xi + k, f4sub(f4sub(zero, ei), or_));
+            f4store(L.xr + M - k - 3, f4reverse(f4add(er, oi)));
+            f4store(L.xi + M - k - 3, f4reverse(f4sub(ei, or_)));
+        }
+
+        for (; k <= M/2; ++k) {
+            const float xkr = a[2*k], xki = -a[2*k + 1];
+            const float xmr = a[2*(M - k)], xmi = a[2*(M - k) + 1];
+
+            const float er = 0.5f*(xkr + xmr), ei = 0.5f*(xki + xmi);
+            const float dr = 0.5f*(xkr - xmr), di = 0.5f*(xki - xmi);
+            const float or_ = dr*L.cr[k] + di*L.ci[k];
+            const float oi  = di*L.cr[k] - dr*L.ci[k];
+
+            L.xr[k] = er - oi;     L.xi[k] = -(ei + or_);
+            L.xr[M - k] = er + oi; L.xi[M - k] = ei - or_;
+        }
+    }
+
+    // each stage reads x and writes y, then the two are swapped
+    float * xr = L.xr; float * xi = L.xi;
+    float * yr = L.yr; float * yi = L.yi;
+
+    auto swapBuffers = [&]() {
+        float * tr = xr; xr = yr; yr = tr;
+        float * ti = xi; xi = yi; yi = ti;
+    };
+
+    wide.radix4First(L, xr, xi, yr, yi);
+    swapBuffers();
+
+    int n = M/4;
+    int s = 4;
+    for (; n >= 4; n /= 4, s *= 4) {
+        (s >= wide.lanes ? wide : base).radix4(L, n, s, xr, xi, yr, yi);
+        swapBuffers();
+    }
+
+    if (n == 2) {
+        wide.radix2(s, xr, xi, yr, yi);
+        swapBuffers();
+    }
+
+    if (isgn >= 0) {
+        // split step: X[k] = E[k] + W^k O[k], X[M - k] = conj(E[k] - W^k O[k])
+        a[0] = xr[0] + xi[0];
+        a[1] = xr[0] - xi[0];
+
+        int k = 1;
+        for (; k + 4 <= M/2; k += 4) {
+            const f4 zkr = f4load(xr + k), zki = f4load(xi + k);
+            const f4 zmr = f4reverse(f4load(xr + M - k - 3));
+            const f4 zmi = f4sub(zero, f4reverse(f4load(xi + M - k - 3)));
+
+            const f4 cr = f4load(L.cr + k), ci = f4load(L.ci + k);
+
+            const f4 er  = f4mul(half, f4add(zkr, zmr)), ei = f4mul(half, f4add(zki, zmi));
+            const f4 or_ = f4mul(half, f4sub(zki, zmi)), oi = f4mul(half, f4sub(zmr, zkr));
+            const f4 tr  = f4sub(f4mul(cr, or_), f4mul(ci, oi));
+            const f4 ti  = f4add(f4mul(cr, oi),  f4mul(ci, or_));
+
+            f4storeInterleaved(a + 2*k, f4add(er, tr), f4sub(f4sub(zero, ei), ti));
+            f4storeInterleaved(a + 2*(M - k - 3), f4reverse(f4sub(er, tr)), f4reverse(f4sub(ei, ti)));
+        }
+
+        for (; k <= M/2; ++k) {
+            const float zkr = xr[k], zki = xi[k];
+            const float zmr = xr[M - k], zmi = -xi[M - k];
+
+            const float er = 0.5f*(zkr + zmr), ei = 0.5f*(zki + zmi);
+            const float or_ = 0.5f*(zki - zmi), oi = -0.5f*(zkr - zmr);
+            const float tr = L.cr[k]*or_ - L.ci[k]*oi;
+            const float ti = L.cr[k]*oi  + L.ci[k]*or_;
+
+            a[2*k] = er + tr;       a[2*k + 1] = -(ei + ti);
+            a[2*(M - k)] = er - tr; a[2*(M - k) + 1] = ei - ti;
+        }
+    } else {
+        for (int n = 0; n < M; n += 4) {
+            f4storeInterleaved(a + 2*n, f4load(xr + n), f4sub(zero, f4load(xi + n)));
+        }
+    }
+}
+
+void rdftSSE2NEON(int N, int isgn, float * a, int * wi, float * wf) {
+    rdftSIMD(N, isgn, a, wi, wf, kFFTKernels, kFFTKernels);
+}
+
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+void rdftAVX2(int N, int isgn, float * a, int * wi, float * wf) {
+    rdftSIMD(N, isgn, a, wi, wf, kFFTKernelsAVX2, kFFTKernels);
+}
+#endif
+#endif
+
+int fftWorkSizeI(int N) { return 3 + sqrt(N/2); }
+int fftWorkSizeF(int N) { return N/2; }
+
+#if defined(GGWAVE_SIMD_SSE2) || defined(GGWAVE_SIMD_NEON)
+int fftWorkSizeFSIMD(int N) { return N < kFFTMinSizeSIMD ? N/2 : FFTLayout::size(N); }
+#endif
+
+const GGWave::FFTBackend kFFTBackendOoura = { "ooura", fftWorkSizeI, fftWorkSizeF, rdft };
+#if defined(GGWAVE_SIMD_SSE2)
+const GGWave::FFTBackend kFFTBackendSIMD  = { "sse2", fftWorkSizeI, fftWorkSizeFSIMD, rdftSSE2NEON };
+#elif defined(GGWAVE_SIMD_NEON)
+const GGWave::FFTBackend kFFTBackendSIMD  = { "neon", fftWorkSizeI, fftWorkSizeFSIMD, rdftSSE2NEON };
+#endif
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+const GGWave::FFTBackend kFFTBackendAVX2  = { "avx2", fftWorkSizeI, fftWorkSizeFSIMD, rdftAVX2 };
+#endif
+
+int getECCBytesForLength(int len) {
+    // return len < 4 ? 2 : GG_MAX(4, 2*(len/5));
+     return GG_MAX(8,len / 4); // 将ECC字节从默认4字节增加到8字节或长度的1/4
+}
+
+int bytesForSampleFormat(GGWave::SampleFormat sampleFormat) {
+    switch (sampleFormat) {
+        case GGWAVE_SAMPLE_FORMAT_UNDEFINED:    return 0;                   break;
+        case GGWAVE_SAMPLE_FORMAT_U8:           return sizeof(uint8_t);     break;
+        case GGWAVE_SAMPLE_FORMAT_I8:           return sizeof(int8_t);      break;
+        case GGWAVE_SAMPLE_FORMAT_U16:          return sizeof(uint16_t);    break;
+        case GGWAVE_SAMPLE_FORMAT_I16:          return sizeof(int16_t);     break;
+        case GGWAVE_SAMPLE_FORMAT_F32:          return sizeof(float);       break;
+    };
+
+    ggprintf("Invalid sample format: %d\n", (int) sampleFormat);
+
+    return 0;
+}
+
+}
+
+//
+// ggvector
+//
+
+template<typename T>
+void ggvector<T>::assign(const ggvector & other) {
+    m_data = other.m_data;
+    m_size = other.m_size;
+}
+
+template<typename T>
+void ggvector<T>::copy(const ggvector & other) {
+    if (this == &other) {
+        assert(false);
+    }
+
+    memcpy(m_data, other.m_data, GG_MIN(m_size, other.m_size)*sizeof(T));
+}
+
+template<typename T>
+void ggvector<T>::zero() {
+    if (m_size > 0) {
+        memset(m_data, 0, m_size*sizeof(T));
+    }
+}
+
+template<typename T>
+void ggvector<T>::zero(int n) {
+    if (n > 0) {
+        memset(m_data, 0, n*sizeof(T));
+    }
+}
+
+template struct ggvector<int16_t>;
+
+//
+// ggmatrix
+//
+
+template <typename T>
+void ggmatrix<T>::zero() {
+    if (m_size0 > 0 && m_size1 > 0) {
+        memset(m_data, 0, m_size0*m_size1*sizeof(T));
+    }
+}
+
+//
+// Protocols
+//
+
+void GGWave::Protocols::enableAll() {
+    for (int i = 0; i < GGWAVE_PROTOCOL_COUNT; i++) {
+        auto & p = this->data[i];
+        if (p.name) {
+            p.enabled = true;
+        }
+    }
+}
+
+void GGWave::Protocols::disableAll() {
+    for (int i = 0; i < GGWAVE_PROTOCOL_COUNT; i++) {
+        auto & p = this->data[i];
+        p.enabled = false;
+    }
+}
+
+void GGWave::Protocols::toggle(ProtocolId id, bool state) {
+    if (state) {
+        // enable protocol
+        data[id].enabled = true;
+    } else {
+        // disable protocol
+        data[id].enabled = false;
+    }
+}
+
+void GGWave::Protocols::only(ProtocolId id) {
+    disableAll();
+    data[id].enabled = true;
+}
+
+GGWave::TxProtocols & GGWave::Protocols::tx() {
+    static TxProtocols protocols = kDefault();
+
+    return protocols;
+}
 
 GGWave::RxProtocols & GGWave::Protocols::rx() {
     static RxProtocols protocols = kDefault();
@@ -479,6 +1570,7 @@ bool GGWave::prepare(const Parameters & parameters, bool allocate) {
 
     m_sampleRateInp        = parameters.sampleRateInp;
     m_sampleRateOut        = parameters.sampleRateOut;
+    m_isRxFastResampler    = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER;
     m_sampleRate           = parameters.sampleRate;
     m_samplesPerFrame      = parameters.samplesPerFrame;
     m_isamplesPerFrame     = 1.0f/m_samplesPerFrame;
@@ -496,11 +1588,49 @@ bool GGWave::prepare(const Parameters & parameters, bool allocate) {
     m_soundMarkerThreshold = parameters.soundMarkerThreshold > 0 ? parameters.soundMarkerThreshold : 1.5f;
     m_isFixedPayloadLength = parameters.payloadLength > 0;
     m_payloadLength        = parameters.payloadLength;
+    m_nPayloadLengthsRx    = 0;
     m_isRxEnabled          = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX;
     m_isTxEnabled          = parameters.operatingMode & GGWAVE_OPERATING_MODE_TX;
-    m_needResampling       = m_sampleRateInp != m_sampleRate || m_sampleRateOut != m_sampleRate;
+    m_needResamplingInp    = m_sampleRateInp != m_sampleRate;
+    m_needResamplingOut    = m_sampleRateOut != m_sampleRate;
     m_txOnlyTones          = parameters.operatingMode & GGWAVE_OPERATING_MODE_TX_ONLY_TONES;
     m_isDSSEnabled         = parameters.operatingMode & GGWAVE_OPERATING_MODE_USE_DSS;
+    m_isAsyncAnalysis      = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_ASYNC_ANALYSIS;
+    m_isTxStream           = parameters.operatingMode & GGWAVE_OPERATING_MODE_TX_STREAM;
+    m_isTxIFFT             = parameters.operatingMode & GGWAVE_OPERATING_MODE_TX_IFFT;
+    m_isRxBandOnly         = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_BAND_ONLY;
+    m_isRxHeterodyne       = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_HETERODYNE;
+    m_isRxEnergyGate       = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_ENERGY_GATE;
+    m_isRxDecimate         = parameters.operatingMode & GGWAVE_OPERATING_MODE_RX_DECIMATE;
+    m_fftBackend           = &fftBackend();
+
+#ifdef ARDUINO
+    // no <atomic> and no second thread for the analysis
+    m_isAsyncAnalysis = false;
+#endif
+
+    // with inline analysis a recording is analyzed as soon as it is complete, so a single slot is enough
+    m_analysis.nRecordings = m_isAsyncAnalysis ? kMaxRecordingSlots : 1;
+
+    // the fixed payload lengths of the receiver, without duplicates. the shortest ones are tried first
+    if (m_isFixedPayloadLength) {
+        m_payloadLengthsRx[m_nPayloadLengthsRx++] = m_payloadLength;
+        for (int i = 0; i < GGWAVE_MAX_RX_PAYLOAD_LENGTHS; ++i) {
+            const int length = g_payloadLengthsRx[i];
+
+            bool isNew = length > 0;
+            for (int j = 0; j < m_nPayloadLengthsRx; ++j) {
+                isNew = isNew && m_payloadLengthsRx[j] != length;
+            }
+            if (isNew) {
+                int j = m_nPayloadLengthsRx++;
+                for (; j > 0 && m_payloadLengthsRx[j - 1] > length; --j) {
+                    m_payloadLengthsRx[j] = m_payloadLengthsRx[j - 1];
+                }
+                m_payloadLengthsRx[j] = length;
+            }
+        }
+    }
 
     if (m_sampleSizeInp == 0) {
         ggprintf("Invalid or unsupported capture sample format: %d\n", (int) parameters.sampleFormatInp);
@@ -527,6 +1657,25 @@ bool GGWave::prepare(const Parameters & parameters, bool allocate) {
         return false;
     }
 
+    // Rx front end:
+
+    m_rx.samplesPerFrame    = m_samplesPerFrame;
+    m_rx.samplesPerFrameInp = m_samplesPerFrame;
+    m_rx.decimation         = 1;
+    m_rx.isHeterodyne       = false;
+    m_rx.binShift           = 0;
+    m_rx.frontEndTaps       = 0;
+
+    if (m_isRxEnabled && (m_isRxDecimate || m_isRxHeterodyne)) {
+        planRxFrontEnd();
+
+        // the input resampler has its own anti-aliasing filter, so it can output the decimated rate directly
+        if (m_rx.decimation > 1 && m_rx.isHeterodyne == false && m_needResamplingInp) {
+            m_rx.samplesPerFrameInp = m_rx.samplesPerFrame;
+            m_rx.frontEndTaps       = 0;
+        }
+    }
+
     // memory allocation:
 
     m_heap = nullptr;
@@ -557,26 +1706,203 @@ bool GGWave::prepare(const Parameters & parameters, bool allocate) {
     }
 
     if (m_isRxEnabled) {
-        m_rx.samplesNeeded = m_samplesPerFrame;
+        m_rx.samplesNeeded = m_rx.samplesPerFrameInp;
+
+        m_rx.noiseFloor     = 0.0f;
+        m_rx.framesGated    = 0;
+        m_rx.nFramesGate    = 0;
+        m_rx.nFramesSkipped = 0;
+
+        m_rx.statsFixed = {};
+
+        m_rx.lastProtocolId  = -1;
+        m_rx.lastLength      = 0;
+        m_rx.lastWindow      = 0;
+        m_rx.framesSinceLast = 0;
 
         m_rx.fftWorkI[0] = 0;
 
+        if (m_isFixedPayloadLength == false) {
+            m_rx.recordingSlot = 0;
+
+            m_analysis.nHandedOver = 0;
+            m_analysis.fftWorkI[0] = 0;
+
+            for (int i = 0; i < m_analysis.nRecordings; ++i) {
+                m_analysis.recordings[i].state = kAnalysisIdle;
+                m_analysis.recordings[i].protocolId = GGWAVE_PROTOCOL_COUNT;
+            }
+        }
+
         m_rx.protocol   = {};
         m_rx.protocolId = GGWAVE_PROTOCOL_COUNT;
         m_rx.protocols  = Protocols::rx();
 
+        // the protocol bins are relative to the decimated spectrum
+        if (m_rx.binShift != 0) {
+            for (int i = 0; i < m_rx.protocols.size(); ++i) {
+                m_rx.protocols[i].freqStart -= m_rx.binShift;
+            }
+        }
+
         m_rx.minFreqStart = minFreqStart(m_rx.protocols);
+
+        if (m_isFixedPayloadLength) {
+            m_rx.voteGroupStart[0] = 0;
+            for (int i = 0; i < m_rx.protocols.size(); ++i) {
+                const auto & protocol = m_rx.protocols[i];
+                m_rx.voteGroupStart[i + 1] = m_rx.voteGroupStart[i] + (protocol.enabled ? protocol.nTones() : 0);
+            }
+
+            // collect the distinct group bins in ascending order
+            m_rx.nSlotsFixed = 0;
+            for (int i = 0; i < m_rx.protocols.size(); ++i) {
+                const auto & protocol = m_rx.protocols[i];
+                for (int g = m_rx.voteGroupStart[i]; g < m_rx.voteGroupStart[i + 1]; ++g) {
+                    const int bin = ::groupBin(protocol, g - m_rx.voteGroupStart[i]);
+                    if (bin < 0 || bin + 16 > m_rx.samplesPerFrame) {
+                        continue;
+                    }
+
+                    int k = 0;
+                    while (k < m_rx.nSlotsFixed && m_rx.slotBinFixed[k] < bin) {
+                        ++k;
+                    }
+                    if (k < m_rx.nSlotsFixed && m_rx.slotBinFixed[k] == bin) {
+                        continue;
+                    }
+                    for (int j = m_rx.nSlotsFixed; j > k; --j) {
+                        m_rx.slotBinFixed[j] = m_rx.slotBinFixed[j - 1];
+                    }
+                    m_rx.slotBinFixed[k] = bin;
+                    ++m_rx.nSlotsFixed;
+                }
+            }
+
+            for (int i = 0; i < m_rx.protocols.size(); ++i) {
+                const auto & protocol = m_rx.protocols[i];
+                for (int g = m_rx.voteGroupStart[i]; g < m_rx.voteGroupStart[i + 1]; ++g) {
+                    const int bin = ::groupBin(protocol, g - m_rx.voteGroupStart[i]);
+
+                    m_rx.voteGroupSlot[g] = -1;
+                    for (int k = 0; k < m_rx.nSlotsFixed; ++k) {
+                        if (m_rx.slotBinFixed[k] == bin) {
+                            m_rx.voteGroupSlot[g] = k;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        m_rx.binStart = m_isRxBandOnly ? m_rx.minFreqStart : 0;
+        m_rx.binEnd   = m_isRxBandOnly ? maxFreqEnd(m_rx.protocols) : m_rx.samplesPerFrame;
+
+        if (m_rx.frontEndTaps > 0) {
+            // Hann-windowed sinc low-pass, shifted up to the center of the band if heterodyning. tap j multiplies
+            // the sample nTaps - 1 - j samples before the output and is stored in the polyphase order of filterDecimate()
+            const int nTaps = m_rx.frontEndTaps;
+            const int D     = m_rx.decimation;
+            const double fc = m_rx.frontEndCutoff;
+            const double wc = m_rx.isHeterodyne ? (2.0*M_PI*(m_rx.binShift + m_rx.samplesPerFrame/4))/m_samplesPerFrame : 0.0;
+
+            double sum = 0.0;
+            for (int k = 0; k < nTaps; ++k) {
+                const double x = 2.0*M_PI*fc*(k - 0.5*(nTaps - 1));
+                const double win = 0.5 - 0.5*cos((2.0*M_PI*(k + 1))/(nTaps + 1));
+                sum += (x == 0.0 ? 1.0 : sin(x)/x)*win;
+            }
+
+            for (int k = 0; k < nTaps; ++k) {
+                const double x = 2.0*M_PI*fc*(k - 0.5*(nTaps - 1));
+                const double win = 0.5 - 0.5*cos((2.0*M_PI*(k + 1))/(nTaps + 1));
+                const double h = (x == 0.0 ? 1.0 : sin(x)/x)*win/sum;
+
+                const int j = nTaps - 1 - k;
+
+                m_rx.frontEndTapsI[(j%D)*(nTaps/D) + j/D] = h*cos(wc*k);
+                if (m_rx.isHeterodyne) {
+                    m_rx.frontEndTapsQ[(j%D)*(nTaps/D) + j/D] = h*sin(wc*k);
+                }
+            }
+        }
+
+        if (m_isRxEnergyGate) {
+            // Hann-windowed sinc band-pass over the bins of the Rx protocols in the analyzed frame, widened by half
+            // of the transition band on each side. the heterodyne moves the bins down by binShift. protocols with
+            // bins above the Nyquist frequency cannot be received, so they do not widen the band
+            const int binShift = m_rx.isHeterodyne ? m_rx.binShift : 0;
+
+            int b0 = m_rx.samplesPerFrame/2;
+            int b1 = 0;
+            for (int i = 0; i < m_rx.protocols.size(); ++i) {
+                const auto & protocol = m_rx.protocols[i];
+                const int freqEnd = protocol.freqStart + 2*16*protocol.bytesPerTx - binShift;
+                if (protocol.enabled == false || freqEnd > m_rx.samplesPerFrame/2) {
+                    continue;
+                }
+                b0 = GG_MIN(b0, protocol.freqStart - binShift);
+                b1 = GG_MAX(b1, freqEnd);
+            }
+
+            if (b0 >= b1) {
+                b0 = 0;
+                b1 = m_rx.samplesPerFrame/2;
+            }
+
+            const int nTaps = m_rx.gateTaps.size();
+            const double fw = 1.55/nTaps;
+            const double f0 = GG_MAX(0.0, double(b0)/m_rx.samplesPerFrame - fw);
+            const double f1 = GG_MIN(0.5, double(b1)/m_rx.samplesPerFrame + fw);
+
+            for (int k = 0; k < nTaps; ++k) {
+                const double x = M_PI*(k - 0.5*(nTaps - 1));
+                const double win = 0.5 - 0.5*cos((2.0*M_PI*(k + 1))/(nTaps + 1));
+
+                m_rx.gateTaps[k] = (sin(2.0*f1*x) - sin(2.0*f0*x))/x*win;
+            }
+        }
+
+        if (m_rx.isHeterodyne) {
+            // after the decimation the center of the band is at bin binShift + samplesPerFrame/4. it is
+            // moved to samplesPerFrame/4, so that the real part keeps the whole band
+            for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+                m_rx.frontEndMixCos[i] = cos((2.0*M_PI*m_rx.binShift*i)/m_rx.samplesPerFrame);
+                m_rx.frontEndMixSin[i] = sin((2.0*M_PI*m_rx.binShift*i)/m_rx.samplesPerFrame);
+            }
+        }
     }
 
     if (m_isTxEnabled) {
         m_tx.protocols = Protocols::tx();
+
+        if (m_txOnlyTones == false) {
+            if (m_isTxIFFT) {
+                m_tx.synthWorkI[0] = 0;
+            } else {
+                for (int i = 0; i < m_samplesPerFrame; ++i) {
+                    m_tx.sinTable[i] = sin((2.0*M_PI*i)/m_samplesPerFrame);
+                    m_tx.cosTable[i] = cos((2.0*M_PI*i)/m_samplesPerFrame);
+                }
+            }
+
+            m_tx.toneFreqStart     = -1;
+            m_tx.toneDataBitsPerTx = -1;
+        }
     }
 
     return init("", {}, 0);
 }
 
 bool GGWave::alloc(void * p, int & n) {
-    const int maxLength   = m_isFixedPayloadLength ? m_payloadLength : kMaxLengthVariable;
+    int maxLength = kMaxLengthVariable;
+    if (m_isFixedPayloadLength) {
+        maxLength = 0;
+        for (int i = 0; i < m_nPayloadLengthsRx; ++i) {
+            maxLength = GG_MAX(maxLength, m_payloadLengthsRx[i]);
+        }
+    }
+
     const int totalLength = maxLength + getECCBytesForLength(maxLength);
     const int totalTxs    = (totalLength + minBytesPerTx(Protocols::rx()) - 1)/minBytesPerTx(Protocols::tx());
 
@@ -590,33 +1916,91 @@ bool GGWave::alloc(void * p, int & n) {
     ::ggalloc(m_dataEncoded, totalLength + m_encodedDataOffset, p, n);
 
     if (m_isRxEnabled) {
-        ::ggalloc(m_rx.fftOut,   2*m_samplesPerFrame, p, n);
-        ::ggalloc(m_rx.fftWorkI, 3 + sqrt(m_samplesPerFrame/2), p, n);
-        ::ggalloc(m_rx.fftWorkF, m_samplesPerFrame/2, p, n);
+        ::ggalloc(m_rx.fftOut,   2*m_rx.samplesPerFrame, p, n);
+        ::ggalloc(m_rx.fftWorkI, m_fftBackend->workSizeI(m_rx.samplesPerFrame), p, n);
+        ::ggalloc(m_rx.fftWorkF, m_fftBackend->workSizeF(m_rx.samplesPerFrame), p, n);
 
-        ::ggalloc(m_rx.spectrum,           m_samplesPerFrame, p, n);
+        ::ggalloc(m_rx.spectrum,           m_rx.samplesPerFrame, p, n);
         // small extra space because sometimes resampling needs a few more samples:
-        ::ggalloc(m_rx.amplitude,          m_needResampling ? m_samplesPerFrame + 128 : m_samplesPerFrame, p, n);
+        ::ggalloc(m_rx.amplitude,          m_needResamplingInp ? m_samplesPerFrame + 128 : m_samplesPerFrame, p, n);
         // min input sampling rate is 0.125*m_sampleRate:
-        ::ggalloc(m_rx.amplitudeResampled, m_needResampling ? 8*m_samplesPerFrame : m_samplesPerFrame, p, n);
-        ::ggalloc(m_rx.amplitudeTmp,       m_needResampling ? 8*m_samplesPerFrame*m_sampleSizeInp : m_samplesPerFrame*m_sampleSizeInp, p, n);
+        if (m_needResamplingInp) {
+            ::ggalloc(m_rx.amplitudeResampled, 8*m_samplesPerFrame, p, n);
+        }
+
+        if (m_isRxEnergyGate) {
+            ::ggalloc(m_rx.gateTaps, GG_MIN(kEnergyGateTaps, m_rx.samplesPerFrame/2), p, n);
+        }
+
+        if (m_rx.frontEndTaps > 0) {
+            ::ggalloc(m_rx.frontEndTapsI,  m_rx.frontEndTaps, p, n);
+            ::ggalloc(m_rx.frontEndInput,  m_rx.frontEndTaps - 1 + m_samplesPerFrame, p, n);
+            ::ggalloc(m_rx.frontEndPhases, m_rx.decimation*frontEndStride(), p, n);
+            ::ggalloc(m_rx.frameDecimated, m_rx.samplesPerFrame, p, n);
+
+            if (m_rx.isHeterodyne) {
+                ::ggalloc(m_rx.frontEndTapsQ,   m_rx.frontEndTaps, p, n);
+                ::ggalloc(m_rx.frontEndMixCos,  m_rx.samplesPerFrame, p, n);
+                ::ggalloc(m_rx.frontEndMixSin,  m_rx.samplesPerFrame, p, n);
+                ::ggalloc(m_rx.frameQuadrature, m_rx.samplesPerFrame, p, n);
+            }
+        }
 
         ::ggalloc(m_rx.data, maxLength + 1, p, n); // extra byte for null-termination
 
         if (m_isFixedPayloadLength) {
-            if (m_payloadLength > kMaxLengthFixed) {
-                ggprintf("Invalid payload length: %d, max: %d\n", m_payloadLength, kMaxLengthFixed);
+            if (maxLength > kMaxLengthFixed) {
+                ggprintf("Invalid payload length: %d, max: %d\n", maxLength, kMaxLengthFixed);
                 return false;
             }
 
-            ::ggalloc(m_rx.spectrumHistoryFixed, totalTxs*maxFramesPerTx(Protocols::rx(), false), m_samplesPerFrame, p, n);
-            ::ggalloc(m_rx.detectedBins,         2*totalLength, p, n);
-            ::ggalloc(m_rx.detectedTones,        2*16*maxBytesPerTx(Protocols::rx()), p, n);
+            // the vote rings reach back over the longest window of totalTxs*framesPerTx frames, of the longest payload
+            int nGroups = 0;
+            int nRows   = 1;
+            for (int i = 0; i < Protocols::rx().size(); ++i) {
+                const auto & protocol = Protocols::rx()[i];
+                if (protocol.enabled == false) {
+                    continue;
+                }
+                nGroups += protocol.nTones();
+                nRows = GG_MAX(nRows, 1 + protocol.extra*((totalLength + protocol.bytesPerTx - 1)/protocol.bytesPerTx)*protocol.framesPerTx);
+            }
+
+            // at most one spectrum slot per tone group
+            ::ggalloc(m_rx.slotBinFixed,  nGroups, p, n);
+            ::ggalloc(m_rx.spectrumFixed, 16*nGroups, p, n);
+
+            ::ggalloc(m_rx.voteGroupStart,  Protocols::rx().size() + 1, p, n);
+            ::ggalloc(m_rx.voteGroupSlot,   nGroups, p, n);
+            ::ggalloc(m_rx.voteTone,        nRows, nGroups, p, n);
+            ::ggalloc(m_rx.voteMajority,    nRows, nGroups, p, n);
+            ::ggalloc(m_rx.voteConfident,   nRows, nGroups, p, n);
+            ::ggalloc(m_rx.voteCount,       16*nGroups, p, n);
+            ::ggalloc(m_rx.voteConfidentCount, nGroups, p, n);
+            ::ggalloc(m_rx.voteDetected,    nRows, Protocols::rx().size(), p, n);
+            ::ggalloc(m_rx.voteDetectedSum, nRows, m_nPayloadLengthsRx*Protocols::rx().size(), p, n);
+
+            ::ggalloc(m_rx.nibblesDetected,  totalLength, p, n);
+            ::ggalloc(m_rx.nibblesConfident, totalLength, p, n);
+            ::ggalloc(m_rx.erasures,         getECCBytesForLength(maxLength), p, n);
+            ::ggalloc(m_rx.eccDecoded,       getECCBytesForLength(maxLength), p, n);
         } else {
             // variable payload length
-            ::ggalloc(m_rx.amplitudeRecorded, kMaxRecordedFrames*m_samplesPerFrame, p, n);
-            ::ggalloc(m_rx.amplitudeAverage,  m_samplesPerFrame, p, n);
-            ::ggalloc(m_rx.amplitudeHistory,  kMaxSpectrumHistory, m_samplesPerFrame, p, n);
+            ::ggalloc(m_rx.amplitudeRecorded, m_analysis.nRecordings, kMaxRecordedFrames*m_rx.samplesPerFrame, p, n);
+            ::ggalloc(m_rx.amplitudeSum,      m_rx.samplesPerFrame, p, n);
+            ::ggalloc(m_rx.amplitudeHistory,  kMaxSpectrumHistory, m_rx.samplesPerFrame, p, n);
+
+            ::ggalloc(m_analysis.fftOut,       2*m_rx.samplesPerFrame, p, n);
+            ::ggalloc(m_analysis.fftWorkI,     m_fftBackend->workSizeI(m_rx.samplesPerFrame), p, n);
+            ::ggalloc(m_analysis.fftWorkF,     m_fftBackend->workSizeF(m_rx.samplesPerFrame), p, n);
+            ::ggalloc(m_analysis.spectrum,     m_rx.samplesPerFrame, p, n);
+            ::ggalloc(m_analysis.dataEncoded,  totalLength + m_encodedDataOffset, p, n);
+            ::ggalloc(m_analysis.workRSLength, RS::ReedSolomon::getWorkSize_bytes(1, m_encodedDataOffset - 1), p, n);
+            ::ggalloc(m_analysis.workRSData,   RS::ReedSolomon::getWorkSize_bytes(maxLength, getECCBytesForLength(maxLength)), p, n);
+
+            for (int i = 0; i < m_analysis.nRecordings; ++i) {
+                ::ggalloc(m_analysis.recordings[i].data, maxLength + 1, p, n);
+            }
         }
     }
 
@@ -625,12 +2009,30 @@ bool GGWave::alloc(void * p, int & n) {
 
         if (m_txOnlyTones == false) {
             ::ggalloc(m_tx.phaseOffsets,    maxDataBits, p, n);
-            ::ggalloc(m_tx.bit0Amplitude,   maxDataBits, m_samplesPerFrame, p, n);
-            ::ggalloc(m_tx.bit1Amplitude,   maxDataBits, m_samplesPerFrame, p, n);
+            ::ggalloc(m_tx.toneBins,        maxDataBits, p, n);
+            ::ggalloc(m_tx.toneSinPhase,    maxDataBits, p, n);
+            ::ggalloc(m_tx.toneCosPhase,    maxDataBits, p, n);
+
+            if (m_isTxIFFT) {
+                ::ggalloc(m_tx.synthSpectrum, m_samplesPerFrame, p, n);
+                ::ggalloc(m_tx.synthWorkI,    m_fftBackend->workSizeI(m_samplesPerFrame), p, n);
+                ::ggalloc(m_tx.synthWorkF,    m_fftBackend->workSizeF(m_samplesPerFrame), p, n);
+            } else {
+                ::ggalloc(m_tx.sinTable,      m_samplesPerFrame, p, n);
+                ::ggalloc(m_tx.cosTable,      m_samplesPerFrame, p, n);
+                ::ggalloc(m_tx.bit0Amplitude, maxDataBits, m_samplesPerFrame, p, n);
+                ::ggalloc(m_tx.bit1Amplitude, maxDataBits, m_samplesPerFrame, p, n);
+            }
+
             ::ggalloc(m_tx.output,          m_samplesPerFrame, p, n);
-            ::ggalloc(m_tx.outputResampled, 2*m_samplesPerFrame, p, n);
-            ::ggalloc(m_tx.outputTmp,       kMaxRecordedFrames*m_samplesPerFrame*m_sampleSizeOut, p, n);
-            ::ggalloc(m_tx.outputI16,       kMaxRecordedFrames*m_samplesPerFrame, p, n);
+            // the resampler outputs at most ceil(samplesPerFrame*sampleRateOut/sampleRate) + 1 samples per frame
+            const int maxSamplesPerFrameOut = (int) ceil(m_samplesPerFrame*m_sampleRateOut/m_sampleRate) + 2;
+            ::ggalloc(m_tx.outputResampled, GG_MAX(2*m_samplesPerFrame, maxSamplesPerFrameOut), p, n);
+
+            if (m_isTxStream == false) {
+                ::ggalloc(m_tx.outputTmp,   kMaxRecordedFrames*m_samplesPerFrame*m_sampleSizeOut, p, n);
+                ::ggalloc(m_tx.outputI16,   kMaxRecordedFrames*m_samplesPerFrame, p, n);
+            }
         }
 
         const int maxTones    = m_isFixedPayloadLength ? maxTonesPerTx(Protocols::tx()) : m_nBitsInMarker;
@@ -650,8 +2052,15 @@ bool GGWave::alloc(void * p, int & n) {
         ::ggalloc(m_workRSData, RS::ReedSolomon::getWorkSize_bytes(maxLength, getECCBytesForLength(maxLength)), p, n);
     }
 
-    if (m_needResampling) {
-        m_resampler.alloc(p, n);
+    if (m_isRxEnabled && m_needResamplingInp) {
+        // the capture is only analyzed, so a short filter is enough to bring it to the operating rate
+        const int width = m_isRxFastResampler ? Resampler::kWidthFast : Resampler::kWidth;
+
+        m_resamplerInp.alloc(m_sampleRateInp, m_sampleRate*m_rx.samplesPerFrameInp/m_samplesPerFrame, p, n, width);
+    }
+
+    if (m_isTxEnabled && m_needResamplingOut) {
+        m_resamplerOut.alloc(m_sampleRate, m_sampleRateOut, p, n);
     }
 
     return true;
@@ -661,6 +2070,48 @@ void GGWave::setLogFile(FILE * fptr) {
     g_fptr = fptr;
 }
 
+const GGWave::FFTBackend & GGWave::fftBackendOoura() {
+    return kFFTBackendOoura;
+}
+
+const GGWave::FFTBackend & GGWave::fftBackendAuto() {
+    static const FFTBackend * backend = []() {
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2")) {
+            return &kFFTBackendAVX2;
+        }
+#endif
+#if defined(GGWAVE_SIMD_SSE2) || defined(GGWAVE_SIMD_NEON)
+        return &kFFTBackendSIMD;
+#else
+        return &kFFTBackendOoura;
+#endif
+    }();
+
+    return *backend;
+}
+
+void GGWave::setFFTBackend(const FFTBackend * backend) {
+    g_fftBackend = backend;
+}
+
+const GGWave::FFTBackend & GGWave::fftBackend() {
+    return g_fftBackend ? *g_fftBackend : fftBackendAuto();
+}
+
+bool GGWave::setRxPayloadLengths(const int * lengths, int n) {
+    if (n < 0 || n > GGWAVE_MAX_RX_PAYLOAD_LENGTHS) {
+        ggprintf("Invalid number of Rx payload lengths: %d, max: %d\n", n, GGWAVE_MAX_RX_PAYLOAD_LENGTHS);
+        return false;
+    }
+
+    for (int i = 0; i < GGWAVE_MAX_RX_PAYLOAD_LENGTHS; ++i) {
+        g_payloadLengthsRx[i] = i < n ? lengths[i] : 0;
+    }
+
+    return true;
+}
+
 const GGWave::Parameters & GGWave::getDefaultParameters() {
     static ggwave_Parameters result {
         -1, // vaiable payload length
@@ -702,6 +2153,7 @@ bool GGWave::init(int dataSize, const char * dataBuffer, TxProtocolId protocolId
         }
 
         m_tx.hasData = false;
+        m_tx.isEncoding = false;
         m_tx.data.zero();
         m_dataEncoded.zero();
 
@@ -746,7 +2198,11 @@ bool GGWave::init(int dataSize, const char * dataBuffer, TxProtocolId protocolId
     // Rx
     if (m_isRxEnabled) {
         m_rx.receiving = false;
+        // an analysis that was handed over to another thread still owns the recording
         m_rx.analyzing = false;
+        for (int i = 0; i < m_analysis.nRecordings; ++i) {
+            m_rx.analyzing |= loadState(m_analysis.recordings[i].state) != kAnalysisIdle;
+        }
 
         m_rx.framesToAnalyze = 0;
         m_rx.framesLeftToAnalyze = 0;
@@ -756,10 +2212,20 @@ bool GGWave::init(int dataSize, const char * dataBuffer, TxProtocolId protocolId
         m_rx.spectrum.zero();
         m_rx.amplitude.zero();
         m_rx.amplitudeHistory.zero();
+        m_rx.amplitudeSum.zero();
 
         m_rx.data.zero();
 
-        m_rx.spectrumHistoryFixed.zero();
+        m_rx.spectrumFixed.zero();
+
+        m_rx.voteRow = 0;
+        m_rx.voteTone.zero();
+        m_rx.voteMajority.zero();
+        m_rx.voteConfident.zero();
+        m_rx.voteCount.zero();
+        m_rx.voteConfidentCount.zero();
+        m_rx.voteDetected.zero();
+        m_rx.voteDetectedSum.zero();
     }
 
     return true;
@@ -774,12 +2240,10 @@ uint32_t GGWave::encodeSize_samples() const {
         return 0;
     }
 
-    float factor = 1.0f;
     int samplesPerFrameOut = m_samplesPerFrame;
-    if (m_needResampling) {
-        factor = m_sampleRate/m_sampleRateOut;
+    if (m_needResamplingOut) {
         // note : +1 extra sample in order to overestimate the buffer size
-        samplesPerFrameOut = m_resampler.resample(factor, m_samplesPerFrame, m_tx.output.data(), nullptr) + 1;
+        samplesPerFrameOut = m_resamplerOut.nSamplesOut(m_samplesPerFrame) + 1;
     }
     const int nECCBytesPerTx = getECCBytesForLength(m_tx.dataLength);
     const int sendDataLength = m_tx.dataLength + m_encodedDataOffset;
@@ -797,8 +2261,74 @@ uint32_t GGWave::encode() {
         return 0;
     }
 
-    if (m_needResampling) {
-        m_resampler.reset();
+    if (m_isTxStream) {
+        ggprintf("Tx is in stream mode - use encodeFrame() to generate the waveform\n");
+        return 0;
+    }
+
+    encodePrepare();
+
+    if (m_txOnlyTones) {
+        m_tx.hasData = false;
+        return true;
+    }
+
+    uint32_t offset = 0;
+
+    while (m_tx.hasData) {
+        const int samplesPerFrameOut = encodeNextFrame();
+
+        // default output is in 16-bit signed int so we always compute it
+        ::convertOutput(m_tx.outputResampled.data(), m_tx.outputI16.data() + offset, samplesPerFrameOut, GGWAVE_SAMPLE_FORMAT_I16);
+
+        if (m_sampleFormatOut != GGWAVE_SAMPLE_FORMAT_I16) {
+            ::convertOutput(m_tx.outputResampled.data(), m_tx.outputTmp.data() + offset*m_sampleSizeOut, samplesPerFrameOut, m_sampleFormatOut);
+        }
+
+        offset += samplesPerFrameOut;
+    }
+
+    m_tx.lastAmplitudeSize = offset;
+
+    // the encoded waveform can be accessed via the txWaveform() method
+    // we return the size of the waveform in bytes:
+    return offset*m_sampleSizeOut;
+}
+
+uint32_t GGWave::encodeFrameSize_bytes() const {
+    // the resampler can produce a few samples more than the average for a single frame
+    return (m_needResamplingOut ? m_tx.outputResampled.size() : m_samplesPerFrame)*m_sampleSizeOut;
+}
+
+uint32_t GGWave::encodeFrame(void * dst) {
+    if (m_isTxEnabled == false || m_txOnlyTones) {
+        ggprintf("Tx waveform is disabled - cannot transmit data with this GGWave instance\n");
+        return 0;
+    }
+
+    if (m_tx.hasData == false) {
+        return 0;
+    }
+
+    if (m_tx.isEncoding == false) {
+        encodePrepare();
+        m_tx.isEncoding = true;
+    }
+
+    const int samplesPerFrameOut = encodeNextFrame();
+
+    ::convertOutput(m_tx.outputResampled.data(), dst, samplesPerFrameOut, m_sampleFormatOut);
+
+    if (m_tx.hasData == false) {
+        m_tx.isEncoding = false;
+    }
+
+    return samplesPerFrameOut*m_sampleSizeOut;
+}
+
+void GGWave::encodePrepare() {
+    if (m_needResamplingOut) {
+        m_resamplerOut.reset();
     }
 
     const int nECCBytesPerTx = getECCBytesForLength(m_tx.dataLength);
@@ -806,6 +2336,9 @@ uint32_t GGWave::encode() {
     const int totalBytes = sendDataLength + nECCBytesPerTx;
     const int totalDataFrames = m_tx.protocol.extra*((totalBytes + m_tx.protocol.bytesPerTx - 1)/m_tx.protocol.bytesPerTx)*m_tx.protocol.framesPerTx;
 
+    m_tx.frameId = 0;
+    m_tx.nFrames = m_nMarkerFrames + totalDataFrames + m_nMarkerFrames;
+
     if (m_isFixedPayloadLength == false) {
         RS::ReedSolomon rsLength(1, m_encodedDataOffset - 1, m_workRSLength.data());
         rsLength.Encode(m_tx.data.data(), m_dataEncoded.data());
@@ -874,15 +2407,17 @@ uint32_t GGWave::encode() {
 
             frameId += m_tx.protocol.framesPerTx;
         }
+    }
 
-        if (m_txOnlyTones) {
-            m_tx.hasData = false;
-            return true;
-        }
+    if (m_txOnlyTones) {
+        return;
     }
 
-    // compute Tx data
-    {
+    // compute the tones, unless they are already available for these protocol parameters
+    if (m_tx.toneFreqStart != m_tx.protocol.freqStart || m_tx.toneDataBitsPerTx != m_tx.protocol.nDataBitsPerTx()) {
+        m_tx.toneFreqStart     = m_tx.protocol.freqStart;
+        m_tx.toneDataBitsPerTx = m_tx.protocol.nDataBitsPerTx();
+
         for (int k = 0; k < (int) m_tx.phaseOffsets.size(); ++k) {
             m_tx.phaseOffsets[k] = (M_PI*k)/(m_tx.protocol.nDataBitsPerTx());
         }
@@ -894,168 +2429,161 @@ uint32_t GGWave::encode() {
         //std::shuffle(phaseOffsets.begin(), phaseOffsets.end(), g);
 
         for (int k = 0; k < (int) m_tx.dataBits.size(); ++k) {
-            const double freq = bitFreq(m_tx.protocol, k);
+            m_tx.toneBins[k]     = ((int) round(bitFreq(m_tx.protocol, k)*m_ihzPerSample)) % m_samplesPerFrame;
+            m_tx.toneSinPhase[k] = sin(m_tx.phaseOffsets[k]);
+            m_tx.toneCosPhase[k] = cos(m_tx.phaseOffsets[k]);
+        }
 
-            const double phaseOffset = m_tx.phaseOffsets[k];
-            const double curHzPerSample = m_hzPerSample;
-            const double curIHzPerSample = 1.0/curHzPerSample;
+        // the IFFT synthesis places the tones directly in the spectrum of each frame
+        if (m_isTxIFFT) {
+            return;
+        }
 
-            for (int i = 0; i < m_samplesPerFrame; i++) {
-                const double curi = i;
-                m_tx.bit1Amplitude[k][i] = sin((2.0*M_PI)*(curi*m_isamplesPerFrame)*(freq*curIHzPerSample) + phaseOffset);
-            }
+        // each tone is an integer number of periods per frame, so sample i of the tone at FFT bin b is
+        // sin(2*pi*(i*b mod N)/N + phaseOffset), which is a lookup in the one-period tables
+        for (int k = 0; k < (int) m_tx.dataBits.size(); ++k) {
+            const int bin1 = m_tx.toneBins[k];
+            const int bin0 = (bin1 + m_freqDelta_bin) % m_samplesPerFrame;
+
+            const float sinOffset = m_tx.toneSinPhase[k];
+            const float cosOffset = m_tx.toneCosPhase[k];
+
+            auto bit1 = m_tx.bit1Amplitude[k];
+            auto bit0 = m_tx.bit0Amplitude[k];
 
+            int j1 = 0;
+            int j0 = 0;
             for (int i = 0; i < m_samplesPerFrame; i++) {
-                const double curi = i;
-                m_tx.bit0Amplitude[k][i] = sin((2.0*M_PI)*(curi*m_isamplesPerFrame)*((freq + m_hzPerSample*m_freqDelta_bin)*curIHzPerSample) + phaseOffset);
+                bit1[i] = m_tx.sinTable[j1]*cosOffset + m_tx.cosTable[j1]*sinOffset;
+                bit0[i] = m_tx.sinTable[j0]*cosOffset + m_tx.cosTable[j0]*sinOffset;
+
+                if ((j1 += bin1) >= m_samplesPerFrame) j1 -= m_samplesPerFrame;
+                if ((j0 += bin0) >= m_samplesPerFrame) j0 -= m_samplesPerFrame;
             }
         }
     }
+}
 
-    int frameId = 0;
-    uint32_t offset = 0;
-    const float factor = m_sampleRate/m_sampleRateOut;
+int GGWave::encodeNextFrame() {
+    if (m_tx.hasData == false) {
+        return 0;
+    }
 
-    while (m_tx.hasData) {
-        m_tx.output.zero();
+    const int frameId = m_tx.frameId;
+    const int totalDataFrames = m_tx.nFrames - 2*m_nMarkerFrames;
 
-        uint16_t nFreq = 0;
-        if (frameId < m_nMarkerFrames) {
-            nFreq = m_nBitsInMarker;
+    m_tx.output.zero();
+    if (m_isTxIFFT) {
+        m_tx.synthSpectrum.zero();
+    }
 
-            for (int i = 0; i < m_nBitsInMarker; ++i) {
-                if (i%2 == 0) {
-                    ::addAmplitudeSmooth(m_tx.bit1Amplitude[i], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, frameId, m_nMarkerFrames);
-                } else {
-                    ::addAmplitudeSmooth(m_tx.bit0Amplitude[i], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, frameId, m_nMarkerFrames);
-                }
-            }
-        } else if (frameId < m_nMarkerFrames + totalDataFrames) {
-            int dataOffset = frameId - m_nMarkerFrames;
-            int cycleModMain = dataOffset%m_tx.protocol.framesPerTx;
-            dataOffset /= m_tx.protocol.framesPerTx;
-            dataOffset *= m_tx.protocol.bytesPerTx;
+    // all tones of a frame share the same envelope
+    int cycleMod  = 0;
+    int nPerCycle = 1;
 
-            m_tx.dataBits.zero();
+    // add the bit1 or bit0 tone of data bit k to the frame
+    const auto addTone = [&](int k, bool isBit1) {
+        if (m_isTxIFFT) {
+            const int bin = m_tx.toneBins[k] + (isBit1 ? 0 : m_freqDelta_bin);
+            ::addToneSpectrum(m_tx.synthSpectrum.data(), m_samplesPerFrame, bin, m_tx.toneSinPhase[k], m_tx.toneCosPhase[k]);
+        } else {
+            ::addAmplitudeSmooth(isBit1 ? m_tx.bit1Amplitude[k] : m_tx.bit0Amplitude[k], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, cycleMod, nPerCycle);
+        }
+    };
 
-            for (int j = 0; j < m_tx.protocol.bytesPerTx; ++j) {
-                if (m_tx.protocol.extra == 1) {
-                    {
-                        uint8_t d = m_dataEncoded[dataOffset + j] & 15;
-                        m_tx.dataBits[(2*j + 0)*16 + d] = 1;
-                    }
-                    {
-                        uint8_t d = m_dataEncoded[dataOffset + j] & 240;
-                        m_tx.dataBits[(2*j + 1)*16 + (d >> 4)] = 1;
-                    }
-                } else {
-                    if (dataOffset % m_tx.protocol.extra == 0) {
-                        uint8_t d = m_dataEncoded[dataOffset/m_tx.protocol.extra + j] & 15;
-                        m_tx.dataBits[(2*j + 0)*16 + d] = 1;
-                    } else {
-                        uint8_t d = m_dataEncoded[dataOffset/m_tx.protocol.extra + j] & 240;
-                        m_tx.dataBits[(2*j + 0)*16 + (d >> 4)] = 1;
-                    }
-                }
-            }
+    uint16_t nFreq = 0;
+    if (frameId < m_nMarkerFrames) {
+        nFreq = m_nBitsInMarker;
 
-            for (int k = 0; k < 2*m_tx.protocol.bytesPerTx*16; ++k) {
-                if (m_tx.dataBits[k] == 0) continue;
+        cycleMod  = frameId;
+        nPerCycle = m_nMarkerFrames;
+        for (int i = 0; i < m_nBitsInMarker; ++i) {
+            addTone(i, i%2 == 0);
+        }
+    } else if (frameId < m_nMarkerFrames + totalDataFrames) {
+        int dataOffset = frameId - m_nMarkerFrames;
+        int cycleModMain = dataOffset%m_tx.protocol.framesPerTx;
+        dataOffset /= m_tx.protocol.framesPerTx;
+        dataOffset *= m_tx.protocol.bytesPerTx;
 
-                ++nFreq;
-                if (k%2) {
-                    ::addAmplitudeSmooth(m_tx.bit0Amplitude[k/2], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, cycleModMain, m_tx.protocol.framesPerTx);
-                } else {
-                    ::addAmplitudeSmooth(m_tx.bit1Amplitude[k/2], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, cycleModMain, m_tx.protocol.framesPerTx);
-                }
-            }
-        } else if (frameId < m_nMarkerFrames + totalDataFrames + m_nMarkerFrames) {
-            nFreq = m_nBitsInMarker;
+        m_tx.dataBits.zero();
 
-            const int fId = frameId - (m_nMarkerFrames + totalDataFrames);
-            for (int i = 0; i < m_nBitsInMarker; ++i) {
-                if (i%2 == 0) {
-                    addAmplitudeSmooth(m_tx.bit0Amplitude[i], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, fId, m_nMarkerFrames);
+        for (int j = 0; j < m_tx.protocol.bytesPerTx; ++j) {
+            if (m_tx.protocol.extra == 1) {
+                {
+                    uint8_t d = m_dataEncoded[dataOffset + j] & 15;
+                    m_tx.dataBits[(2*j + 0)*16 + d] = 1;
+                }
+                {
+                    uint8_t d = m_dataEncoded[dataOffset + j] & 240;
+                    m_tx.dataBits[(2*j + 1)*16 + (d >> 4)] = 1;
+                }
+            } else {
+                if (dataOffset % m_tx.protocol.extra == 0) {
+                    uint8_t d = m_dataEncoded[dataOffset/m_tx.protocol.extra + j] & 15;
+                    m_tx.dataBits[(2*j + 0)*16 + d] = 1;
                 } else {
-                    addAmplitudeSmooth(m_tx.bit1Amplitude[i], m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, fId, m_nMarkerFrames);
+                    uint8_t d = m_dataEncoded[dataOffset/m_tx.protocol.extra + j] & 240;
+                    m_tx.dataBits[(2*j + 0)*16 + (d >> 4)] = 1;
                 }
             }
-        } else {
-            m_tx.hasData = false;
-            break;
         }
 
-        if (nFreq == 0) nFreq = 1;
-        const float scale = 1.0f/nFreq;
-        for (int i = 0; i < m_samplesPerFrame; ++i) {
-            m_tx.output[i] *= scale;
-        }
+        cycleMod  = cycleModMain;
+        nPerCycle = m_tx.protocol.framesPerTx;
+        for (int k = 0; k < 2*m_tx.protocol.bytesPerTx*16; ++k) {
+            if (m_tx.dataBits[k] == 0) continue;
 
-        int samplesPerFrameOut = m_samplesPerFrame;
-        if (m_needResampling) {
-            samplesPerFrameOut = m_resampler.resample(factor, m_samplesPerFrame, m_tx.output.data(), m_tx.outputResampled.data());
-        } else {
-            m_tx.outputResampled.copy(m_tx.output);
+            ++nFreq;
+            addTone(k/2, k%2 == 0);
         }
+    } else if (frameId < m_nMarkerFrames + totalDataFrames + m_nMarkerFrames) {
+        nFreq = m_nBitsInMarker;
 
-        // default output is in 16-bit signed int so we always compute it
-        for (int i = 0; i < samplesPerFrameOut; ++i) {
-            m_tx.outputI16[offset + i] = 32768*m_tx.outputResampled[i];
+        cycleMod  = frameId - (m_nMarkerFrames + totalDataFrames);
+        nPerCycle = m_nMarkerFrames;
+        for (int i = 0; i < m_nBitsInMarker; ++i) {
+            addTone(i, i%2 != 0);
         }
+    } else {
+        m_tx.hasData = false;
+        return 0;
+    }
 
-        // convert from 32-bit float
-        switch (m_sampleFormatOut) {
-            case GGWAVE_SAMPLE_FORMAT_UNDEFINED: break;
-            case GGWAVE_SAMPLE_FORMAT_U8:
-                {
-                    auto p = reinterpret_cast<uint8_t *>(m_tx.outputTmp.data());
-                    for (int i = 0; i < samplesPerFrameOut; ++i) {
-                        p[offset + i] = 128*(m_tx.outputResampled[i] + 1.0f);
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_I8:
-                {
-                    auto p = reinterpret_cast<uint8_t *>(m_tx.outputTmp.data());
-                    for (int i = 0; i < samplesPerFrameOut; ++i) {
-                        p[offset + i] = 128*m_tx.outputResampled[i];
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_U16:
-                {
-                    auto p = reinterpret_cast<uint16_t *>(m_tx.outputTmp.data());
-                    for (int i = 0; i < samplesPerFrameOut; ++i) {
-                        p[offset + i] = 32768*(m_tx.outputResampled[i] + 1.0f);
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_I16:
-                {
-                    // skip because we already have the data in m_tx.outputI16
-                    //auto p = reinterpret_cast<uint16_t *>(m_tx.outputTmp.data());
-                    //for (int i = 0; i < samplesPerFrameOut; ++i) {
-                    //    p[offset + i] = 32768*m_tx.outputResampled[i];
-                    //}
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_F32:
-                {
-                    auto p = reinterpret_cast<float *>(m_tx.outputTmp.data());
-                    for (int i = 0; i < samplesPerFrameOut; ++i) {
-                        p[offset + i] = m_tx.outputResampled[i];
-                    }
-                } break;
-        }
+    if (m_isTxIFFT) {
+        ::IFFT(*m_fftBackend, m_tx.synthSpectrum.data(), m_samplesPerFrame, m_tx.synthWorkI.data(), m_tx.synthWorkF.data());
+        ::addAmplitudeSmooth(m_tx.synthSpectrum, m_tx.output, m_tx.sendVolume, 0, m_samplesPerFrame, cycleMod, nPerCycle);
+    }
+
+    if (nFreq == 0) nFreq = 1;
+    const float scale = 1.0f/nFreq;
+    for (int i = 0; i < m_samplesPerFrame; ++i) {
+        m_tx.output[i] *= scale;
+    }
 
-        ++frameId;
-        offset += samplesPerFrameOut;
+    int samplesPerFrameOut = m_samplesPerFrame;
+    if (m_needResamplingOut) {
+        samplesPerFrameOut = m_resamplerOut.resample(m_samplesPerFrame, m_tx.output.data(), m_tx.outputResampled.data());
+    } else {
+        m_tx.outputResampled.copy(m_tx.output);
     }
 
-    m_tx.lastAmplitudeSize = offset;
+    if (++m_tx.frameId >= m_tx.nFrames) {
+        m_tx.hasData = false;
+    }
 
-    // the encoded waveform can be accessed via the txWaveform() method
-    // we return the size of the waveform in bytes:
-    return offset*m_sampleSizeOut;
+    return samplesPerFrameOut;
 }
 
 bool GGWave::decode(const void * data, uint32_t nBytes) {
+    return decode(data, nBytes, false);
+}
+
+bool GGWave::decodeInPlace(const void * data, uint32_t nBytes) {
+    return decode(data, nBytes, true);
+}
+
+bool GGWave::decode(const void * data, uint32_t nBytes, bool inPlace) {
     if (m_isRxEnabled == false) {
         ggprintf("Rx is disabled - cannot receive data with this GGWave instance\n");
         return false;
@@ -1066,16 +2594,34 @@ bool GGWave::decode(const void * data, uint32_t nBytes) {
         return false;
     }
 
-    auto dataBuffer = (uint8_t *) data;
+    auto dataBuffer = (const uint8_t *) data;
     const float factor = m_sampleRateInp/m_sampleRate;
 
+    // whole frames can be analyzed straight from the caller buffer only if no conversion is needed
+    inPlace = inPlace &&
+        m_sampleFormatInp == GGWAVE_SAMPLE_FORMAT_F32 &&
+        m_needResamplingInp == false &&
+        reinterpret_cast<uintptr_t>(dataBuffer) % alignof(float) == 0;
+
+    const uint32_t nBytesPerFrame = m_rx.samplesPerFrameInp*m_sampleSizeInp;
+
     while (true) {
+        if (inPlace && m_rx.samplesNeeded == m_rx.samplesPerFrameInp && nBytes >= nBytesPerFrame) {
+            m_rx.frame = (const float *) dataBuffer;
+
+            decodeFrame();
+
+            dataBuffer += nBytesPerFrame;
+            nBytes -= nBytesPerFrame;
+
+            continue;
+        }
+
         // read capture data
         uint32_t nBytesNeeded = m_rx.samplesNeeded*m_sampleSizeInp;
 
-        if (m_needResampling) {
-            // note : predict 4 extra samples just to make sure we have enough data
-            nBytesNeeded = (m_resampler.resample(1.0f/factor, m_rx.samplesNeeded, m_rx.amplitudeResampled.data(), nullptr) + 4)*m_sampleSizeInp;
+        if (m_needResamplingInp) {
+            nBytesNeeded = m_resamplerInp.nSamplesInp(m_rx.samplesNeeded)*m_sampleSizeInp;
         }
 
         const uint32_t nBytesRecorded = GG_MIN(nBytes, nBytesNeeded);
@@ -1084,109 +2630,49 @@ bool GGWave::decode(const void * data, uint32_t nBytes) {
             break;
         }
 
-        switch (m_sampleFormatInp) {
-            case GGWAVE_SAMPLE_FORMAT_UNDEFINED: break;
-            case GGWAVE_SAMPLE_FORMAT_U8:
-            case GGWAVE_SAMPLE_FORMAT_I8:
-            case GGWAVE_SAMPLE_FORMAT_U16:
-            case GGWAVE_SAMPLE_FORMAT_I16:
-                {
-                    memcpy(m_rx.amplitudeTmp.data(), dataBuffer, nBytesRecorded);
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_F32:
-                {
-                    memcpy(m_rx.amplitudeResampled.data(), dataBuffer, nBytesRecorded);
-                } break;
-        }
-
-        dataBuffer += nBytesRecorded;
-        nBytes -= nBytesRecorded;
-
         if (nBytesRecorded % m_sampleSizeInp != 0) {
             ggprintf("Failure during capture - provided bytes (%d) are not multiple of sample size (%d)\n",
                     nBytesRecorded, m_sampleSizeInp);
-            m_rx.samplesNeeded = m_samplesPerFrame;
+            m_rx.samplesNeeded = m_rx.samplesPerFrameInp;
             break;
         }
 
-        // convert to 32-bit float
-        int nSamplesRecorded = nBytesRecorded/m_sampleSizeInp;
-        switch (m_sampleFormatInp) {
-            case GGWAVE_SAMPLE_FORMAT_UNDEFINED: break;
-            case GGWAVE_SAMPLE_FORMAT_U8:
-                {
-                    constexpr float scale = 1.0f/128;
-                    auto p = reinterpret_cast<uint8_t *>(m_rx.amplitudeTmp.data());
-                    for (int i = 0; i < nSamplesRecorded; ++i) {
-                        m_rx.amplitudeResampled[i] = float(int16_t(*(p + i)) - 128)*scale;
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_I8:
-                {
-                    constexpr float scale = 1.0f/128;
-                    auto p = reinterpret_cast<int8_t *>(m_rx.amplitudeTmp.data());
-                    for (int i = 0; i < nSamplesRecorded; ++i) {
-                        m_rx.amplitudeResampled[i] = float(*(p + i))*scale;
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_U16:
-                {
-                    constexpr float scale = 1.0f/32768;
-                    auto p = reinterpret_cast<uint16_t *>(m_rx.amplitudeTmp.data());
-                    for (int i = 0; i < nSamplesRecorded; ++i) {
-                        m_rx.amplitudeResampled[i] = float(int32_t(*(p + i)) - 32768)*scale;
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_I16:
-                {
-                    constexpr float scale = 1.0f/32768;
-                    auto p = reinterpret_cast<int16_t *>(m_rx.amplitudeTmp.data());
-                    for (int i = 0; i < nSamplesRecorded; ++i) {
-                        m_rx.amplitudeResampled[i] = float(*(p + i))*scale;
-                    }
-                } break;
-            case GGWAVE_SAMPLE_FORMAT_F32: break;
-        }
+        const int offset = m_rx.samplesPerFrameInp - m_rx.samplesNeeded;
 
-        uint32_t offset = m_samplesPerFrame - m_rx.samplesNeeded;
+        // convert to 32-bit float, straight from the caller buffer
+        int nSamplesRecorded = nBytesRecorded/m_sampleSizeInp;
 
-        if (m_needResampling) {
-            if (nSamplesRecorded <= 2*Resampler::kWidth) {
-                m_rx.samplesNeeded = m_samplesPerFrame;
-                break;
-            }
+        if (m_needResamplingInp) {
+            ::convertInput(dataBuffer, m_rx.amplitudeResampled.data(), nSamplesRecorded, m_sampleFormatInp);
 
             // reset resampler state every minute
-            if (!m_rx.receiving && m_resampler.nSamplesTotal() > 60.0f*factor*m_sampleRate) {
-                m_resampler.reset();
+            if (!m_rx.receiving && m_resamplerInp.nSamplesTotal() > 60.0f*factor*m_sampleRate) {
+                m_resamplerInp.reset();
             }
 
-            int nSamplesResampled = offset + m_resampler.resample(factor, nSamplesRecorded, m_rx.amplitudeResampled.data(), m_rx.amplitude.data() + offset);
-            nSamplesRecorded = nSamplesResampled;
+            nSamplesRecorded = m_resamplerInp.resample(nSamplesRecorded, m_rx.amplitudeResampled.data(), m_rx.amplitude.data() + offset);
         } else {
-            for (int i = 0; i < nSamplesRecorded; ++i) {
-                m_rx.amplitude[offset + i] = m_rx.amplitudeResampled[i];
-            }
+            ::convertInput(dataBuffer, m_rx.amplitude.data() + offset, nSamplesRecorded, m_sampleFormatInp);
         }
 
+        dataBuffer += nBytesRecorded;
+        nBytes -= nBytesRecorded;
+
+        nSamplesRecorded += offset;
+
         // we have enough bytes to do analysis
-        if (nSamplesRecorded >= m_samplesPerFrame) {
+        if (nSamplesRecorded >= m_rx.samplesPerFrameInp) {
+            m_rx.frame = m_rx.amplitude.data();
             m_rx.hasNewAmplitude = true;
 
-            if (m_isFixedPayloadLength) {
-                decode_fixed();
-            } else {
-                decode_variable();
-            }
+            decodeFrame();
 
-            int nExtraSamples = nSamplesRecorded - m_samplesPerFrame;
-            for (int i = 0; i < nExtraSamples; ++i) {
-                m_rx.amplitude[i] = m_rx.amplitude[m_samplesPerFrame + i];
-            }
+            const int nExtraSamples = nSamplesRecorded - m_rx.samplesPerFrameInp;
+            memmove(m_rx.amplitude.data(), m_rx.amplitude.data() + m_rx.samplesPerFrameInp, nExtraSamples*sizeof(float));
 
-            m_rx.samplesNeeded = m_samplesPerFrame - nExtraSamples;
+            m_rx.samplesNeeded = m_rx.samplesPerFrameInp - nExtraSamples;
         } else {
-            m_rx.samplesNeeded = m_samplesPerFrame - nSamplesRecorded;
+            m_rx.samplesNeeded = m_rx.samplesPerFrameInp - nSamplesRecorded;
             break;
         }
     }
@@ -1194,6 +2680,93 @@ bool GGWave::decode(const void * data, uint32_t nBytes) {
     return true;
 }
 
+void GGWave::decodeFrame() {
+    if (m_rx.frontEndTaps > 0) {
+        decimateFrame();
+    }
+
+    if (m_isRxEnergyGate) {
+        updateEnergyGate();
+    }
+
+    if (m_isFixedPayloadLength) {
+        decode_fixed();
+    } else {
+        decode_variable();
+    }
+}
+
+void GGWave::decimateFrame() {
+    const int nTaps  = m_rx.frontEndTaps;
+    const int D      = m_rx.decimation;
+    const int stride = frontEndStride();
+
+    float * input  = m_rx.frontEndInput.data();
+    float * phases = m_rx.frontEndPhases.data();
+
+    memcpy(input + nTaps - 1, m_rx.frame, m_samplesPerFrame*sizeof(float));
+
+    for (int p = 0; p < D; ++p) {
+        for (int i = 0; i < stride; ++i) {
+            phases[p*stride + i] = input[i*D + p];
+        }
+    }
+
+    const auto kernel = ::filterDecimateKernel();
+
+    kernel(phases, stride, D, m_rx.frontEndTapsI.data(), nTaps/D, m_rx.frameDecimated.data(), m_rx.samplesPerFrame);
+
+    if (m_rx.isHeterodyne) {
+        kernel(phases, stride, D, m_rx.frontEndTapsQ.data(), nTaps/D, m_rx.frameQuadrature.data(), m_rx.samplesPerFrame);
+
+        float * re = m_rx.frameDecimated.data();
+        const float * im   = m_rx.frameQuadrature.data();
+        const float * mixC = m_rx.frontEndMixCos.data();
+        const float * mixS = m_rx.frontEndMixSin.data();
+
+        for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+            re[i] = re[i]*mixC[i] + im[i]*mixS[i];
+        }
+    }
+
+    memmove(input, input + m_samplesPerFrame, (nTaps - 1)*sizeof(float));
+
+    m_rx.frame = m_rx.frameDecimated.data();
+}
+
+void GGWave::updateEnergyGate() {
+    // mean square of the band-passed frame. the noise outside of the protocol band does not hide the signal
+    const int nTaps  = m_rx.gateTaps.size();
+    const int stride = GG_MAX(1, m_rx.samplesPerFrame/kEnergyGateOutputs);
+
+    float energy = 0.0f;
+    int nOutputs = 0;
+    for (int i = 0; i + nTaps <= m_rx.samplesPerFrame; i += stride) {
+        const float y = ::dotProduct(m_rx.frame + i, m_rx.gateTaps.data(), nTaps);
+
+        energy += y*y;
+        ++nOutputs;
+    }
+    energy /= nOutputs;
+
+    if (m_rx.nFramesGate++ == 0) {
+        m_rx.noiseFloor = energy;
+    } else {
+        m_rx.noiseFloor = GG_MIN(energy, GG_MAX(m_rx.noiseFloor, kEnergyGateMin)*kEnergyGateFloorRise);
+    }
+
+    if (energy <= GG_MAX(kEnergyGateThreshold*m_rx.noiseFloor, kEnergyGateMin)) {
+        ++m_rx.framesGated;
+    } else {
+        m_rx.framesGated = 0;
+    }
+}
+
+int GGWave::frontEndStride() const {
+    // length of the polyphase components of the input, enough for all taps of the last output
+    return m_rx.samplesPerFrame + m_rx.frontEndTaps/m_rx.decimation - 1;
+}
+
 //
 // instance state
 //
@@ -1258,12 +2831,48 @@ bool GGWave::rxReceiving() const { return m_rx.receiving; }
 bool GGWave::rxAnalyzing() const { return m_rx.analyzing; }
 
 int GGWave::rxSamplesNeeded()       const { return m_rx.samplesNeeded; }
+int GGWave::rxSamplesPerFrame()     const { return m_rx.samplesPerFrame; }
 int GGWave::rxFramesToRecord()      const { return m_rx.framesToRecord; }
 int GGWave::rxFramesLeftToRecord()  const { return m_rx.framesLeftToRecord; }
 int GGWave::rxFramesToAnalyze()     const { return m_rx.framesToAnalyze; }
 int GGWave::rxFramesLeftToAnalyze() const { return m_rx.framesLeftToAnalyze; }
 int GGWave::rxDurationFrames()      const { return m_rx.recvDuration_frames; }
 
+const GGWave::RxStatsFixed & GGWave::rxStatsFixed() const { return m_rx.statsFixed; }
+
+float GGWave::rxEnergyGateHitRate() const {
+    return m_rx.nFramesGate > 0 ? float(m_rx.nFramesSkipped)/m_rx.nFramesGate : 0.0f;
+}
+
+bool GGWave::rxAnalyze() {
+    // analyze the recordings in the order in which they were handed over
+    int slot = -1;
+    for (int i = 0; i < m_analysis.nRecordings; ++i) {
+        const auto & recording = m_analysis.recordings[i];
+        if (loadState(recording.state) != kAnalysisPending) {
+            continue;
+        }
+
+        if (slot == -1 || isHandedOverBefore(recording.id, m_analysis.recordings[slot].id)) {
+            slot = i;
+        }
+    }
+
+    if (slot == -1) {
+        return false;
+    }
+
+    auto & recording = m_analysis.recordings[slot];
+
+    storeState(recording.state, kAnalysisRunning);
+
+    analyze(slot);
+
+    storeState(recording.state, kAnalysisDone);
+
+    return true;
+}
+
 bool GGWave::rxStopReceiving() {
     if (m_rx.receiving == false) {
         return false;
@@ -1316,21 +2925,23 @@ bool GGWave::rxTakeAmplitude(Amplitude & dst) {
 }
 
 bool GGWave::computeFFTR(const float * src, float * dst, int N) {
-    if (N != m_samplesPerFrame) {
-        ggprintf("computeFFTR: N (%d) must be equal to 'samplesPerFrame' %d\n", N, m_samplesPerFrame);
+    if (N != m_rx.samplesPerFrame) {
+        ggprintf("computeFFTR: N (%d) must be equal to 'rxSamplesPerFrame' %d\n", N, m_rx.samplesPerFrame);
         return false;
     }
 
-    FFT(src, dst, N, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
+    FFT(*m_fftBackend, src, dst, N, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
 
     return true;
 }
 
 int GGWave::computeFFTR(const float * src, float * dst, int N, int * wi, float * wf) {
-    if (wi == nullptr) return 2*N;
-    if (wf == nullptr) return 3 + sqrt(N/2);
+    const auto & fft = fftBackend();
+
+    if (wi == nullptr) return fft.workSizeI(N);
+    if (wf == nullptr) return fft.workSizeF(N);
 
-    FFT(src, dst, N, wi, wf);
+    FFT(fft, src, dst, N, wi, wf);
 
     return 1;
 }
@@ -1410,14 +3021,33 @@ int GGWave::filter(ggwave_Filter filter, float * waveform, int N, float p0, floa
 
 GGWave::Resampler::Resampler() {}
 
-bool GGWave::Resampler::alloc(void * p, int & n) {
-    ggalloc(m_sincTable,   kWidth*kSamplesPerZeroCrossing, p, n);
-    ggalloc(m_delayBuffer, 3*kWidth, p, n);
-    ggalloc(m_edgeSamples, kWidth, p, n);
-    ggalloc(m_samplesInp,  4096, p, n);
+bool GGWave::Resampler::alloc(float sampleRateInp, float sampleRateOut, void * p, int & n, int width) {
+    m_width = GG_MAX(1, GG_MIN(kWidth, width));
+    m_taps  = 2*m_width;
+
+    // dotProduct() processes the filter phases in steps of 8 taps
+    assert(m_taps % 8 == 0);
+
+    const int rateInp = sampleRateInp;
+    const int rateOut = sampleRateOut;
+
+    if (rateInp > 0 && rateOut > 0 && rateInp == sampleRateInp && rateOut == sampleRateOut) {
+        const int g = ::gcd(rateInp, rateOut);
+
+        m_num = rateInp/g;
+        m_den = rateOut/g;
+    } else {
+        m_den = 1 << kFracBits;
+        m_num = round((double(sampleRateInp)/sampleRateOut)*m_den);
+    }
+
+    m_isExact = m_den <= kMaxExactPhases;
+
+    ggalloc(m_filter,     (m_isExact ? m_den : kPhases + 1)*m_taps, p, n);
+    ggalloc(m_samplesInp, m_taps + kMaxSamplesInp, p, n);
 
     if (p) {
-        makeSinc();
+        makeFilter();
         reset();
     }
 
@@ -1426,139 +3056,125 @@ bool GGWave::Resampler::alloc(void * p, int & n) {
 
 void GGWave::Resampler::reset() {
     m_state = {};
-    m_edgeSamples.zero();
-    m_delayBuffer.zero();
+    m_state.timeInt = m_taps;
     m_samplesInp.zero();
 }
 
+// output k of the next call is at time (timeInt*den + timePhase + k*num)/den and is produced while its
+// right-most tap is available, i.e. while the time is less than m_width + nSamplesInp
+int GGWave::Resampler::nSamplesOut(int nSamplesInp) const {
+    const int64_t timeNow = int64_t(m_state.timeInt)*m_den + m_state.timePhase;
+    const int64_t timeEnd = int64_t(m_width + nSamplesInp)*m_den;
+
+    if (timeNow >= timeEnd) {
+        return 0;
+    }
+
+    return (timeEnd - timeNow + m_num - 1)/m_num;
+}
+
+int GGWave::Resampler::nSamplesInp(int nSamplesOut) const {
+    if (nSamplesOut <= 0) {
+        return 0;
+    }
+
+    // the last output needs the input sample at floor(time) + m_width, counted from the start of the history
+    const int64_t timeLast = int64_t(m_state.timeInt)*m_den + m_state.timePhase + int64_t(nSamplesOut - 1)*m_num;
+    const int nInp = timeLast/m_den + m_width - m_taps + 1;
+
+    return nInp > 0 ? nInp : 0;
+}
+
 int GGWave::Resampler::resample(
-        float factor,
         int nSamples,
         const float * samplesInp,
         float * samplesOut) {
-    int idxInp = -1;
-    int idxOut = 0;
-    int notDone = 1;
-    float data_in = 0.0f;
-    float data_out = 0.0f;
-    double one_over_factor = 1.0;
-
-    auto stateSave = m_state;
+    int nOut = 0;
+    while (nSamples > 0) {
+        const int nBlock = GG_MIN(nSamples, kMaxSamplesInp);
 
-    m_state.nSamplesTotal += nSamples;
+        nOut += resampleBlock(nBlock, samplesInp, samplesOut + nOut);
 
-    if (samplesOut) {
-        assert(nSamples > kWidth);
-        assert((int) m_samplesInp.size() >= nSamples + kWidth);
-        //if ((int) m_samplesInp.size() < nSamples + kWidth) {
-        //    m_samplesInp.resize(nSamples + kWidth);
-        //}
-        for (int i = 0; i < kWidth; ++i) {
-            m_samplesInp[i] = m_edgeSamples[i];
-            m_edgeSamples[i] = samplesInp[nSamples - kWidth + i];
-        }
-        for (int i = 0; i < nSamples; ++i) {
-            m_samplesInp[i + kWidth] = samplesInp[i];
-        }
-        samplesInp = m_samplesInp.data();
+        samplesInp += nBlock;
+        nSamples   -= nBlock;
     }
 
-    while (notDone) {
-        while (m_state.timeLast < m_state.timeInt) {
-            if (++idxInp >= nSamples) {
-                notDone = 0;
-                break;
-            } else {
-                data_in = samplesInp[idxInp];
-            }
-            //printf("xxxx idxInp = %d\n", idxInp);
-            if (samplesOut) newData(data_in);
-            m_state.timeLast += 1;
-        }
+    return nOut;
+}
 
-        if (notDone == false) break;
+int GGWave::Resampler::resampleBlock(int nSamples, const float * samplesInp, float * samplesOut) {
+    const int nTotal = m_taps + nSamples;
 
-        double temp1 = 0.0;
-        int left_limit = m_state.timeNow - kWidth + 1; /* leftmost neighboring sample used for interp.*/
-        int right_limit = m_state.timeNow + kWidth;    /* rightmost leftmost neighboring sample used for interp.*/
-        if (left_limit < 0) left_limit = 0;
-        if (right_limit > m_state.nSamplesTotal + kWidth) right_limit = m_state.nSamplesTotal + kWidth;
-        if (factor < 1.0) {
-            for (int j = left_limit; j < right_limit; j++) {
-                temp1 += getData(j - m_state.timeInt)*sinc(m_state.timeNow - (double) j);
-            }
-            data_out = temp1;
-        }
-        else {
-            one_over_factor = 1.0 / factor;
-            for (int j = left_limit; j < right_limit; j++) {
-                temp1 += getData(j - m_state.timeInt)*one_over_factor*sinc(one_over_factor*(m_state.timeNow - (double) j));
-            }
-            data_out = temp1;
-        }
+    const int stepInt   = m_num/m_den;
+    const int stepPhase = m_num%m_den;
+
+    memcpy(m_samplesInp.data() + m_taps, samplesInp, nSamples*sizeof(float));
+
+    int timeInt   = m_state.timeInt;
+    int timePhase = m_state.timePhase;
+
+    const float scale = 1.0f/m_den;
+
+    // outputs are produced while the right-most tap is available
+    int idxOut = 0;
+    while (timeInt + m_width < nTotal) {
+        const float * x = m_samplesInp.data() + timeInt - m_width + 1;
+
+        if (m_isExact) {
+            samplesOut[idxOut] = ::dotProduct(x, m_filter.data() + timePhase*m_taps, m_taps);
+        } else {
+            const int64_t phase = int64_t(timePhase)*kPhases;
+
+            const int   iPhase = phase/m_den;
+            const float frac   = (phase - int64_t(iPhase)*m_den)*scale;
 
-        if (samplesOut) {
-            //printf("inp = %d, l = %d, r = %d, n = %d, a = %d, b = %d\n", idxInp, left_limit, right_limit, m_state.nSamplesTotal, left_limit - m_state.timeInt, right_limit - m_state.timeInt - 1);
-            samplesOut[idxOut] = data_out;
+            const float y0 = ::dotProduct(x, m_filter.data() + (iPhase + 0)*m_taps, m_taps);
+            const float y1 = ::dotProduct(x, m_filter.data() + (iPhase + 1)*m_taps, m_taps);
+
+            samplesOut[idxOut] = y0 + frac*(y1 - y0);
         }
         ++idxOut;
 
-        m_state.timeNow += factor;
-        m_state.timeLast = m_state.timeInt;
-        m_state.timeInt = m_state.timeNow;
-        while (m_state.timeLast < m_state.timeInt) {
-            if (++idxInp >= nSamples) {
-                notDone = 0;
-                break;
-            } else {
-                data_in = samplesInp[idxInp];
-            }
-            if (samplesOut) newData(data_in);
-            m_state.timeLast += 1;
+        timeInt   += stepInt;
+        timePhase += stepPhase;
+        if (timePhase >= m_den) {
+            timePhase -= m_den;
+            ++timeInt;
         }
-        //printf("last idxInp = %d, nSamples = %d\n", idxInp, nSamples);
     }
 
-    if (samplesOut == nullptr) {
-        m_state = stateSave;
-    }
+    // keep the last m_taps input samples as history for the next call
+    memmove(m_samplesInp.data(), m_samplesInp.data() + nSamples, m_taps*sizeof(float));
+
+    m_state.nSamplesTotal += nSamples;
+    m_state.timeInt        = timeInt - nSamples;
+    m_state.timePhase      = timePhase;
 
     return idxOut;
 }
 
-float GGWave::Resampler::getData(int j) const {
-    return m_delayBuffer[(int) j + kWidth];
-}
+void GGWave::Resampler::makeFilter() {
+    // when downsampling, the cutoff is lowered to the output Nyquist frequency
+    const double scale = m_num > m_den ? double(m_den)/m_num : 1.0;
 
-void GGWave::Resampler::newData(float data) {
-    for (int i = 0; i < kDelaySize - 5; i++) {
-        m_delayBuffer[i] = m_delayBuffer[i + 1];
-    }
-    m_delayBuffer[kDelaySize - 5] = data;
-}
+    const int nPhases = m_isExact ? m_den : kPhases + 1;
+    for (int p = 0; p < nPhases; ++p) {
+        const double frac = m_isExact ? double(p)/m_den : double(p)/kPhases;
+        float * h = m_filter.data() + p*m_taps;
 
-void GGWave::Resampler::makeSinc() {
-    double temp, win_freq, win;
-    win_freq = M_PI/kWidth/kSamplesPerZeroCrossing;
-    m_sincTable[0] = 1.0;
-    for (int i = 1; i < kWidth*kSamplesPerZeroCrossing; i++) {
-        temp = (double) i*M_PI/kSamplesPerZeroCrossing;
-        m_sincTable[i] = sin(temp)/temp;
-        win = 0.5 + 0.5*cos(win_freq*i);
-        m_sincTable[i] *= win;
-    }
-}
+        for (int j = 0; j < m_taps; ++j) {
+            // distance between the output sample and input tap j
+            const double d = frac + (m_width - 1) - j;
+            if (fabs(d) >= m_width) {
+                h[j] = 0.0f;
+                continue;
+            }
 
-double GGWave::Resampler::sinc(double x) const {
-    int low;
-    double temp, delta;
-    if (fabs(x) >= kWidth - 1) {
-        return 0.0;
-    } else {
-        temp = fabs(x)*(double) kSamplesPerZeroCrossing;
-        low = temp;          /* these are interpolation steps */
-        delta = temp - low;  /* and can be ommited if desired */
-        return linear_interp(m_sincTable[low], m_sincTable[low + 1], delta);
+            const double x = M_PI*scale*d;
+            const double win = 0.5 + 0.5*cos(M_PI*d/m_width);
+
+            h[j] = (x == 0.0 ? 1.0 : sin(x)/x)*scale*win;
+        }
     }
 }
 
@@ -1567,211 +3183,95 @@ double GGWave::Resampler::sinc(double x) const {
 //
 
 void GGWave::decode_variable() {
-    m_rx.amplitudeHistory[m_rx.historyId].copy(m_rx.amplitude);
+    if (m_rx.analyzing) {
+        deliverAnalysis();
+    }
+
+    // slide the averaging window by one frame: add the newest frame to the running sum and drop the
+    // oldest one, which is the history row that is about to be overwritten
+    {
+        auto oldest = m_rx.amplitudeHistory[m_rx.historyId];
+        for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+            m_rx.amplitudeSum[i] += m_rx.frame[i] - oldest[i];
+        }
+        memcpy(oldest.data(), m_rx.frame, m_rx.samplesPerFrame*sizeof(float));
+    }
 
     if (++m_rx.historyId >= kMaxSpectrumHistory) {
         m_rx.historyId = 0;
     }
 
-    if (m_rx.historyId == 0 || m_rx.receiving) {
-        m_rx.hasNewSpectrum = true;
+    if (++m_rx.historyResync >= kSpectrumHistoryResyncFrames) {
+        m_rx.historyResync = 0;
 
-        m_rx.amplitudeAverage.zero();
+        m_rx.amplitudeSum.zero();
         for (int j = 0; j < (int) m_rx.amplitudeHistory.size(); ++j) {
             auto s = m_rx.amplitudeHistory[j];
-            for (int i = 0; i < m_samplesPerFrame; ++i) {
-                m_rx.amplitudeAverage[i] += s[i];
+            for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+                m_rx.amplitudeSum[i] += s[i];
             }
         }
-
-        float norm = 1.0f/kMaxSpectrumHistory;
-        for (int i = 0; i < m_samplesPerFrame; ++i) {
-            m_rx.amplitudeAverage[i] *= norm;
-        }
-
-        // calculate spectrum
-        FFT(m_rx.amplitudeAverage.data(), m_rx.fftOut.data(), m_samplesPerFrame, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
-
-        for (int i = 0; i < m_samplesPerFrame; ++i) {
-            m_rx.spectrum[i] = (m_rx.fftOut[2*i + 0]*m_rx.fftOut[2*i + 0] + m_rx.fftOut[2*i + 1]*m_rx.fftOut[2*i + 1]);
-        }
-        for (int i = 1; i < m_samplesPerFrame/2; ++i) {
-            m_rx.spectrum[i] += m_rx.spectrum[m_samplesPerFrame - i];
-        }
     }
 
-    if (m_rx.framesLeftToRecord > 0) {
-        memcpy(m_rx.amplitudeRecorded.data() + (m_rx.framesToRecord - m_rx.framesLeftToRecord)*m_samplesPerFrame,
-               m_rx.amplitude.data(),
-               m_samplesPerFrame*sizeof(float));
+    // while idle, skip the spectrum and the marker check if all frames in the averaging window are below the
+    // energy gate
+    const bool isIdle = m_rx.receiving == false && m_rx.framesLeftToRecord == 0;
+    const bool isGated = isIdle && m_isRxEnergyGate && m_rx.framesGated >= kMaxSpectrumHistory;
+    const bool isMarkerSuspected = isGated == false;
 
-        if (--m_rx.framesLeftToRecord <= 0) {
-            m_rx.analyzing = true;
-        }
+    if (isGated) {
+        ++m_rx.nFramesSkipped;
     }
 
-    if (m_rx.analyzing) {
-        ggprintf("Analyzing captured data ..\n");
-
-        const int stepsPerFrame = 16;
-        const int step = m_samplesPerFrame/stepsPerFrame;
+    m_rx.hasNewSpectrum = isMarkerSuspected;
 
-        bool isValid = false;
-        for (int protocolId = 0; protocolId < (int) m_rx.protocols.size(); ++protocolId) {
-            const auto & protocol = m_rx.protocols[protocolId];
-            if (protocol.enabled == false) {
-                continue;
-            }
-
-            // skip Rx protocol if it is mono-tone
-            if (protocol.extra == 2) {
-                continue;
-            }
-
-            // skip Rx protocol if start frequency is different from detected one
-            if (protocol.freqStart != m_rx.markerFreqStart) {
-                continue;
-            }
-
-            m_rx.spectrum.zero();
-
-            m_rx.framesToAnalyze = m_nMarkerFrames*stepsPerFrame;
-            m_rx.framesLeftToAnalyze = m_rx.framesToAnalyze;
-
-            // note : not sure if looping backwards here is more meaningful than looping forwards
-            for (int ii = m_nMarkerFrames*stepsPerFrame - 1; ii >= 0; --ii) {
-                bool knownLength = false;
-
-                int decodedLength = 0;
-                const int offsetStart = ii;
-                for (int itx = 0; itx < 1024; ++itx) {
-                    int offsetTx = offsetStart + itx*protocol.framesPerTx*stepsPerFrame;
-                    if (offsetTx >= m_rx.recvDuration_frames*stepsPerFrame || (itx + 1)*protocol.bytesPerTx >= (int) m_dataEncoded.size()) {
-                        break;
-                    }
-
-                    memcpy(m_rx.fftOut.data(),
-                           m_rx.amplitudeRecorded.data() + offsetTx*step,
-                           m_samplesPerFrame*sizeof(float));
-
-                    // note : should we skip the first and last frame here as they are amplitude-smoothed?
-                    for (int k = 1; k < protocol.framesPerTx; ++k) {
-                        for (int i = 0; i < m_samplesPerFrame; ++i) {
-                            m_rx.fftOut[i] += m_rx.amplitudeRecorded[(offsetTx + k*stepsPerFrame)*step + i];
-                        }
-                    }
-
-                    FFT(m_rx.fftOut.data(), m_samplesPerFrame, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
-
-                    for (int i = 0; i < m_samplesPerFrame; ++i) {
-                        m_rx.spectrum[i] = (m_rx.fftOut[2*i + 0]*m_rx.fftOut[2*i + 0] + m_rx.fftOut[2*i + 1]*m_rx.fftOut[2*i + 1]);
-                    }
-                    for (int i = 1; i < m_samplesPerFrame/2; ++i) {
-                        m_rx.spectrum[i] += m_rx.spectrum[m_samplesPerFrame - i];
-                    }
-
-                    uint8_t curByte = 0;
-                    for (int i = 0; i < 2*protocol.bytesPerTx; ++i) {
-                        double freq = m_hzPerSample*protocol.freqStart;
-                        int bin = round(freq*m_ihzPerSample) + 16*i;
-
-                        int kmax = 0;
-                        double amax = 0.0;
-                        for (int k = 0; k < 16; ++k) {
-                            if (m_rx.spectrum[bin + k] > amax) {
-                                kmax = k;
-                                amax = m_rx.spectrum[bin + k];
-                            }
-                        }
-
-                        if (i%2) {
-                            curByte += (kmax << 4);
-                            m_dataEncoded[itx*protocol.bytesPerTx + i/2] = curByte;
-                            curByte = 0;
-                        } else {
-                            curByte = kmax;
-                        }
-                    }
-
-                    if (itx*protocol.bytesPerTx > m_encodedDataOffset && knownLength == false) {
-                        RS::ReedSolomon rsLength(1, m_encodedDataOffset - 1, m_workRSLength.data());
-                        if ((rsLength.Decode(m_dataEncoded.data(), m_rx.data.data()) == 0) && (m_rx.data[0] > 0 && m_rx.data[0] <= 140)) {
-                            knownLength = true;
-                            decodedLength = m_rx.data[0];
-                            //printf("decoded length = %d, recvDuration_frames = %d\n", decodedLength, m_rx.recvDuration_frames);
-
-                            const int nTotalBytesExpected = m_encodedDataOffset + decodedLength + ::getECCBytesForLength(decodedLength);
-                            const int nTotalFramesExpected = 2*m_nMarkerFrames + ((nTotalBytesExpected + protocol.bytesPerTx - 1)/protocol.bytesPerTx)*protocol.framesPerTx;
-                            if (m_rx.recvDuration_frames > nTotalFramesExpected ||
-                                m_rx.recvDuration_frames < nTotalFramesExpected - 2*m_nMarkerFrames) {
-                                //printf("  - invalid number of frames: %d (expected %d)\n", m_rx.recvDuration_frames, nTotalFramesExpected);
-                                knownLength = false;
-                                break;
-                            }
-                        } else {
-                            break;
-                        }
-                    }
-
-                    {
-                        const int nTotalBytesExpected = m_encodedDataOffset + decodedLength + ::getECCBytesForLength(decodedLength);
-                        if (knownLength && itx*protocol.bytesPerTx > nTotalBytesExpected + 1) {
-                            break;
-                        }
-                    }
-                }
-
-                if (knownLength) {
-                    RS::ReedSolomon rsData(decodedLength, ::getECCBytesForLength(decodedLength), m_workRSData.data());
-
-                    if (rsData.Decode(m_dataEncoded.data() + m_encodedDataOffset, m_rx.data.data()) == 0) {
-                        if (decodedLength > 0) {
-                            if (m_isDSSEnabled) {
-                                for (int i = 0; i < decodedLength; ++i) {
-                                    m_rx.data[i] = m_rx.data[i] ^ getDSSMagic(i);
-                                }
-                            }
-
-                            ggprintf("Decoded length = %d, protocol = '%s' (%d)\n", decodedLength, protocol.name, protocolId);
-                            ggprintf("Received sound data successfully: '%s'\n", m_rx.data.data());
+    // calculate spectrum of the average amplitude
+    if (isMarkerSuspected) {
+        const float norm = 1.0f/kMaxSpectrumHistory;
+        for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+            m_rx.fftOut[i] = m_rx.amplitudeSum[i]*norm;
+        }
 
-                            isValid = true;
-                            m_rx.hasNewRxData = true;
-                            m_rx.dataLength = decodedLength;
-                            m_rx.protocol = protocol;
-                            m_rx.protocolId = RxProtocolId(protocolId);
-                        }
-                    }
-                }
+        FFT(*m_fftBackend, m_rx.fftOut.data(), m_rx.samplesPerFrame, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
 
-                if (isValid) {
-                    break;
-                }
-                --m_rx.framesLeftToAnalyze;
-            }
+        ::powerSpectrum(m_rx.fftOut.data(), m_rx.spectrum.data(), m_rx.samplesPerFrame, m_rx.binStart, m_rx.binEnd);
+    }
 
-            if (isValid) break;
-        }
+    if (m_rx.framesLeftToRecord > 0) {
+        memcpy(m_rx.amplitudeRecorded[m_rx.recordingSlot].data() + (m_rx.framesToRecord - m_rx.framesLeftToRecord)*m_rx.samplesPerFrame,
+               m_rx.frame,
+               m_rx.samplesPerFrame*sizeof(float));
 
-        m_rx.framesToRecord = 0;
+        if (--m_rx.framesLeftToRecord <= 0) {
+            // hand the recording over to the analysis
+            auto & recording = m_analysis.recordings[m_rx.recordingSlot];
 
-        if (isValid == false) {
-            ggprintf("Failed to capture sound data. Please try again (length = %d)\n", m_rx.data[0]);
-            m_rx.dataLength = -1;
-            m_rx.framesToRecord = -1;
-        }
+            recording.id                  = m_analysis.nHandedOver++;
+            recording.recvDuration_frames = m_rx.recvDuration_frames;
+            recording.markerFreqStart     = m_rx.markerFreqStart;
 
-        m_rx.receiving = false;
-        m_rx.analyzing = false;
+            m_rx.receiving = false;
+            m_rx.analyzing = true;
 
-        m_rx.spectrum.zero();
+            m_rx.framesToAnalyze     = 2*kAnalysisSearchRadius + 1;
+            m_rx.framesLeftToAnalyze = m_rx.framesToAnalyze;
 
-        m_rx.framesToAnalyze = 0;
-        m_rx.framesLeftToAnalyze = 0;
+            if (m_isAsyncAnalysis) {
+                storeState(recording.state, kAnalysisPending);
+            } else {
+                analyze(m_rx.recordingSlot);
+                storeState(recording.state, kAnalysisDone);
+                deliverAnalysis();
+            }
+        }
     }
 
-    // check if receiving data
-    if (m_rx.receiving == false) {
+    // check if receiving data - a new reception needs a recording slot that is not being analyzed
+    const int recordingSlot = m_rx.receiving ? m_rx.recordingSlot : freeRecordingSlot();
+
+    if (m_rx.receiving == false && (isMarkerSuspected == false || recordingSlot == -1)) {
+        m_rx.nMarkersSuccess = 0;
+    } else if (m_rx.receiving == false) {
         bool isReceiving = false;
 
         for (int i = 0; i < m_rx.protocols.size(); ++i) {
@@ -1780,20 +3280,7 @@ void GGWave::decode_variable() {
                 continue;
             }
 
-            int nDetectedMarkerBits = 0;
-
-            for (int i = 0; i < m_nBitsInMarker; ++i) {
-                double freq = bitFreq(protocol, i);
-                int bin = round(freq*m_ihzPerSample);
-
-                if (i%2 == 0) {
-                    if (m_rx.spectrum[bin] > m_soundMarkerThreshold*m_rx.spectrum[bin + m_freqDelta_bin]) ++nDetectedMarkerBits;
-                } else {
-                    if (m_rx.spectrum[bin] < m_soundMarkerThreshold*m_rx.spectrum[bin + m_freqDelta_bin]) ++nDetectedMarkerBits;
-                }
-            }
-
-            if (nDetectedMarkerBits >= m_nBitsInMarker - 2) {
+            if (nMarkerBits(m_rx.spectrum, protocol, true) >= m_nBitsInMarker - 2) {
                 m_rx.markerFreqStart = protocol.freqStart;
                 isReceiving = true;
                 break;
@@ -1813,7 +3300,7 @@ void GGWave::decode_variable() {
             ggprintf("Receiving sound data ...\n");
 
             m_rx.receiving = true;
-            m_rx.data.zero();
+            m_rx.recordingSlot = recordingSlot;
 
             // max recieve duration
             m_rx.recvDuration_frames =
@@ -1835,20 +3322,7 @@ void GGWave::decode_variable() {
                 continue;
             }
 
-            int nDetectedMarkerBits = 0;
-
-            for (int i = 0; i < m_nBitsInMarker; ++i) {
-                double freq = bitFreq(protocol, i);
-                int bin = round(freq*m_ihzPerSample);
-
-                if (i%2 == 0) {
-                    if (m_rx.spectrum[bin] >= m_soundMarkerThreshold*m_rx.spectrum[bin + m_freqDelta_bin]) nDetectedMarkerBits++;
-                } else {
-                    if (m_rx.spectrum[bin] <= m_soundMarkerThreshold*m_rx.spectrum[bin + m_freqDelta_bin]) nDetectedMarkerBits++;
-                }
-            }
-
-            if (nDetectedMarkerBits >= m_nBitsInMarker - 2) {
+            if (nMarkerBits(m_rx.spectrum, protocol, false) >= m_nBitsInMarker - 2) {
                 isEnded = true;
                 break;
             }
@@ -1872,44 +3346,17 @@ void GGWave::decode_variable() {
     }
 }
 
-//
-// Fixed payload length
-
-void GGWave::decode_fixed() {
-    m_rx.hasNewSpectrum = true;
-
-    // calculate spectrum
-    FFT(m_rx.amplitude.data(), m_rx.fftOut.data(), m_samplesPerFrame, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
-
-    float amax = 0.0f;
-    for (int i = 0; i < m_samplesPerFrame; ++i) {
-        m_rx.spectrum[i] = (m_rx.fftOut[2*i + 0]*m_rx.fftOut[2*i + 0] + m_rx.fftOut[2*i + 1]*m_rx.fftOut[2*i + 1]);
-    }
-    for (int i = 1; i < m_samplesPerFrame/2; ++i) {
-        m_rx.spectrum[i] += m_rx.spectrum[m_samplesPerFrame - i];
-        if (i >= m_rx.minFreqStart) {
-            amax = GG_MAX(amax, m_rx.spectrum[i]);
-        }
-    }
+void GGWave::analyze(int slot) {
+    ggprintf("Analyzing captured data ..\n");
 
-    // original, floating-point version
-    //m_rx.spectrumHistoryFixed[m_rx.historyIdFixed].copy(m_rx.spectrum);
+    auto & recording = m_analysis.recordings[slot];
 
-    // float -> uint8_t
-    amax = 255.0f/(amax == 0.0f ? 1.0f : amax);
-    for (int i = 0; i < m_samplesPerFrame; ++i) {
-        m_rx.spectrumHistoryFixed[m_rx.historyIdFixed][i] = GG_MIN(255.0f, GG_MAX(0.0f, (float) round(m_rx.spectrum[i]*amax)));
-    }
+    recording.data.zero();
 
-    // float -> uint16_t
-    //amax = 65535.0f/(amax == 0.0f ? 1.0f : amax);
-    //for (int i = 0; i < m_samplesPerFrame; ++i) {
-    //    m_rx.spectrumHistoryFixed[m_rx.historyIdFixed][i] = GG_MIN(65535.0f, GG_MAX(0.0f, (float) round(m_rx.spectrum[i]*amax)));
-    //}
+    const int stepsPerFrame = kAnalysisStepsPerFrame;
+    const int step = m_rx.samplesPerFrame/stepsPerFrame;
 
-    if (++m_rx.historyIdFixed >= (int) m_rx.spectrumHistoryFixed.size()) {
-        m_rx.historyIdFixed = 0;
-    }
+    const int nCandidates = 2*kAnalysisSearchRadius + 1;
 
     bool isValid = false;
     for (int protocolId = 0; protocolId < (int) m_rx.protocols.size(); ++protocolId) {
@@ -1918,129 +3365,485 @@ void GGWave::decode_fixed() {
             continue;
         }
 
-        const int binStart = protocol.freqStart;
-        const int binDelta = 16;
-        const int binOffset = protocol.extra == 1 ? binDelta : 0;
-
-        if (binStart > m_samplesPerFrame) {
+        // skip Rx protocol if it is mono-tone
+        if (protocol.extra == 2) {
             continue;
         }
 
-        const int totalLength = m_payloadLength + getECCBytesForLength(m_payloadLength);
-        const int totalTxs = protocol.extra*((totalLength + protocol.bytesPerTx - 1)/protocol.bytesPerTx);
-
-        int historyStartId = m_rx.historyIdFixed - totalTxs*protocol.framesPerTx;
-        if (historyStartId < 0) {
-            historyStartId += m_rx.spectrumHistoryFixed.size();
+        // skip Rx protocol if start frequency is different from detected one
+        if (protocol.freqStart != recording.markerFreqStart) {
+            continue;
         }
 
-        const int nTones = 2*protocol.bytesPerTx;
-        m_rx.detectedBins.zero();
+        // timing acquisition: the data starts one frame after the last frame of the recording that still
+        // passes the start marker check. the check is done on a coarse grid of whole frames and the last
+        // match is then refined to a single step with a binary search
+        int dataStart = 0;
+        {
+            const int nStepsMax = GG_MIN(m_nMarkerFrames + 1, recording.recvDuration_frames - 1)*stepsPerFrame;
+
+            int markerEnd = -1;
+            for (int s = 0; s < nStepsMax; s += stepsPerFrame) {
+                recordedSpectrum(slot, s*step, 1);
+                if (nMarkerBits(m_analysis.spectrum, protocol, true) >= m_nBitsInMarker - 2) {
+                    markerEnd = s;
+                }
+            }
+
+            if (markerEnd >= 0) {
+                int hi = markerEnd + stepsPerFrame;
+                while (hi - markerEnd > 1) {
+                    const int mid = (markerEnd + hi)/2;
+                    recordedSpectrum(slot, mid*step, 1);
+                    if (nMarkerBits(m_analysis.spectrum, protocol, true) >= m_nBitsInMarker - 2) {
+                        markerEnd = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
 
-        int txNeededTotal   = 0;
-        int txDetectedTotal = 0;
-        bool detectedSignal = true;
+                dataStart = markerEnd + stepsPerFrame;
+            }
+        }
 
-        for (int k = 0; k < totalTxs; ++k) {
-            if (k % protocol.extra == 0) {
-                m_rx.detectedTones.zero(16*nTones);
+        // try the offsets around the estimated data start, nearest first. each window is summed in the time domain
+        // and transformed once. building the windows from cached spectra of the single frames would take more FFTs:
+        // the candidates touch more distinct frames than they evaluate windows
+        for (int ic = 0; ic < nCandidates; ++ic) {
+            const int ii = dataStart + (ic%2 ? -1 : 1)*((ic + 1)/2);
+            if (ii < 0) {
+                continue;
             }
 
-            for (int i = 0; i < protocol.framesPerTx; ++i) {
-                int historyId = historyStartId + k*protocol.framesPerTx + i;
-                if (historyId >= (int) m_rx.spectrumHistoryFixed.size()) {
-                    historyId -= m_rx.spectrumHistoryFixed.size();
+            bool knownLength = false;
+
+            int decodedLength = 0;
+            const int offsetStart = ii;
+            for (int itx = 0; itx < 1024; ++itx) {
+                int offsetTx = offsetStart + itx*protocol.framesPerTx*stepsPerFrame;
+                if (offsetTx >= recording.recvDuration_frames*stepsPerFrame || (itx + 1)*protocol.bytesPerTx >= (int) m_analysis.dataEncoded.size()) {
+                    break;
                 }
 
-                for (int j = 0; j < protocol.bytesPerTx; ++j) {
-                    int f0bin = 0;
-                    auto f0max = m_rx.spectrumHistoryFixed[historyId][binStart + 2*j*binDelta];
+                // note : should we skip the first and last frame here as they are amplitude-smoothed?
+                recordedSpectrum(slot, offsetTx*step, protocol.framesPerTx);
 
-                    for (int b = 1; b < 16; ++b) {
-                        {
-                            const auto & v = m_rx.spectrumHistoryFixed[historyId][binStart + 2*j*binDelta + b];
+                uint8_t curByte = 0;
+                for (int i = 0; i < 2*protocol.bytesPerTx; ++i) {
+                    double freq = m_hzPerSample*protocol.freqStart;
+                    int bin = round(freq*m_ihzPerSample) + 16*i;
 
-                            if (f0max <= v) {
-                                f0max = v;
-                                f0bin = b;
-                            }
-                        }
+                    float ratio = 0.0f;
+                    const int kmax = ::argmax16(m_analysis.spectrum.data() + bin, ratio);
+
+                    if (i%2) {
+                        curByte += (kmax << 4);
+                        m_analysis.dataEncoded[itx*protocol.bytesPerTx + i/2] = curByte;
+                        curByte = 0;
+                    } else {
+                        curByte = kmax;
                     }
+                }
 
-                    int f1bin = 0;
-                    if (protocol.extra == 1) {
-                        auto f1max = m_rx.spectrumHistoryFixed[historyId][binStart + 2*j*binDelta + binOffset];
-                        for (int b = 1; b < 16; ++b) {
-                            const auto & v = m_rx.spectrumHistoryFixed[historyId][binStart + 2*j*binDelta + binOffset + b];
+                if (itx*protocol.bytesPerTx > m_encodedDataOffset && knownLength == false) {
+                    RS::ReedSolomon rsLength(1, m_encodedDataOffset - 1, m_analysis.workRSLength.data());
+                    if ((rsLength.Decode(m_analysis.dataEncoded.data(), recording.data.data()) == 0) && (recording.data[0] > 0 && recording.data[0] <= 140)) {
+                        knownLength = true;
+                        decodedLength = recording.data[0];
+                        //printf("decoded length = %d, recvDuration_frames = %d\n", decodedLength, recording.recvDuration_frames);
 
-                            if (f1max <= v) {
-                                f1max = v;
-                                f1bin = b;
-                            }
+                        const int nTotalBytesExpected = m_encodedDataOffset + decodedLength + ::getECCBytesForLength(decodedLength);
+                        const int nTotalFramesExpected = 2*m_nMarkerFrames + ((nTotalBytesExpected + protocol.bytesPerTx - 1)/protocol.bytesPerTx)*protocol.framesPerTx;
+                        if (recording.recvDuration_frames > nTotalFramesExpected ||
+                            recording.recvDuration_frames < nTotalFramesExpected - 2*m_nMarkerFrames) {
+                            //printf("  - invalid number of frames: %d (expected %d)\n", recording.recvDuration_frames, nTotalFramesExpected);
+                            knownLength = false;
+                            break;
                         }
                     } else {
-                        f1bin = f0bin;
+                        break;
                     }
+                }
 
-                    if ((k + 0)%protocol.extra == 0) m_rx.detectedTones[(2*j + 0)*16 + f0bin]++;
-                    if ((k + 1)%protocol.extra == 0) m_rx.detectedTones[(2*j + 1)*16 + f1bin]++;
+                {
+                    const int nTotalBytesExpected = m_encodedDataOffset + decodedLength + ::getECCBytesForLength(decodedLength);
+                    if (knownLength && itx*protocol.bytesPerTx > nTotalBytesExpected + 1) {
+                        break;
+                    }
                 }
             }
 
-            if (protocol.extra > 1 && (k % protocol.extra == 0)) continue;
+            if (knownLength) {
+                RS::ReedSolomon rsData(decodedLength, ::getECCBytesForLength(decodedLength), m_analysis.workRSData.data());
 
-            int txNeeded = 0;
-            int txDetected = 0;
-            for (int j = 0; j < protocol.bytesPerTx; ++j) {
-                if ((k/protocol.extra)*protocol.bytesPerTx + j >= totalLength) break;
-                txNeeded += 2;
-                for (int b = 0; b < 16; ++b) {
-                    if (m_rx.detectedTones[(2*j + 0)*16 + b] > protocol.framesPerTx/2) {
-                        m_rx.detectedBins[2*((k/protocol.extra)*protocol.bytesPerTx + j) + 0] = b;
-                        txDetected++;
-                    }
-                    if (m_rx.detectedTones[(2*j + 1)*16 + b] > protocol.framesPerTx/2) {
-                        m_rx.detectedBins[2*((k/protocol.extra)*protocol.bytesPerTx + j) + 1] = b;
-                        txDetected++;
+                if (rsData.Decode(m_analysis.dataEncoded.data() + m_encodedDataOffset, recording.data.data()) == 0) {
+                    if (decodedLength > 0) {
+                        if (m_isDSSEnabled) {
+                            for (int i = 0; i < decodedLength; ++i) {
+                                recording.data[i] = recording.data[i] ^ getDSSMagic(i);
+                            }
+                        }
+
+                        ggprintf("Decoded length = %d, protocol = '%s' (%d)\n", decodedLength, protocol.name, protocolId);
+                        ggprintf("Received sound data successfully: '%s'\n", recording.data.data());
+
+                        isValid = true;
+                        recording.dataLength = decodedLength;
+                        recording.protocolId = RxProtocolId(protocolId);
                     }
                 }
             }
 
-            txDetectedTotal += txDetected;
-            txNeededTotal += txNeeded;
+            if (isValid) {
+                break;
+            }
+        }
+
+        if (isValid) break;
+    }
+
+    if (isValid == false) {
+        ggprintf("Failed to capture sound data. Please try again (length = %d)\n", recording.data[0]);
+    }
+
+    recording.isValid = isValid;
+}
+
+void GGWave::deliverAnalysis() {
+    // the results are delivered in the order in which the recordings were handed over
+    int slot = -1;
+    bool isBusy = false;
+    for (int i = 0; i < m_analysis.nRecordings; ++i) {
+        const auto & recording = m_analysis.recordings[i];
+        if (loadState(recording.state) == kAnalysisIdle) {
+            continue;
+        }
+
+        if (slot == -1 || isHandedOverBefore(recording.id, m_analysis.recordings[slot].id)) {
+            slot = i;
+        }
+    }
+
+    if (slot == -1) {
+        m_rx.analyzing = false;
+        return;
+    }
+
+    auto & recording = m_analysis.recordings[slot];
+    if (loadState(recording.state) != kAnalysisDone) {
+        return;
+    }
+
+    if (recording.isValid) {
+        m_rx.data.copy(recording.data);
+
+        m_rx.hasNewRxData = true;
+        m_rx.dataLength = recording.dataLength;
+        m_rx.protocol = m_rx.protocols[recording.protocolId];
+        m_rx.protocolId = recording.protocolId;
+    } else {
+        m_rx.dataLength = -1;
+    }
+
+    // a reception that has started in the meantime keeps its recording progress
+    if (m_rx.framesLeftToRecord == 0) {
+        m_rx.framesToRecord = recording.isValid ? 0 : -1;
+    }
+
+    storeState(recording.state, kAnalysisIdle);
+
+    for (int i = 0; i < m_analysis.nRecordings; ++i) {
+        isBusy |= loadState(m_analysis.recordings[i].state) != kAnalysisIdle;
+    }
+
+    m_rx.analyzing = isBusy;
+
+    if (m_rx.analyzing == false) {
+        m_rx.framesToAnalyze = 0;
+        m_rx.framesLeftToAnalyze = 0;
+    }
+}
+
+int GGWave::freeRecordingSlot() const {
+    for (int i = 0; i < m_analysis.nRecordings; ++i) {
+        if (loadState(m_analysis.recordings[i].state) == kAnalysisIdle) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+//
+// Fixed payload length
+
+void GGWave::decode_fixed() {
+    // a frame below the energy gate goes into the history as silence
+    const bool isGated = m_isRxEnergyGate && m_rx.framesGated > 0;
+
+    m_rx.hasNewSpectrum = isGated == false;
+
+    if (isGated) {
+        ++m_rx.nFramesSkipped;
+
+        m_rx.spectrumFixed.zero(16*m_rx.nSlotsFixed);
+    } else {
+        // calculate spectrum
+        FFT(*m_fftBackend, m_rx.frame, m_rx.fftOut.data(), m_rx.samplesPerFrame, m_rx.fftWorkI.data(), m_rx.fftWorkF.data());
+
+        ::powerSpectrum(m_rx.fftOut.data(), m_rx.spectrum.data(), m_rx.samplesPerFrame, m_rx.binStart, m_rx.binEnd);
+
+        float amax = 0.0f;
+        for (int i = GG_MAX(1, m_rx.minFreqStart); i < GG_MIN(m_rx.binEnd, m_rx.samplesPerFrame/2); ++i) {
+            amax = GG_MAX(amax, m_rx.spectrum[i]);
+        }
+
+        // float -> uint8_t, only the bins of the tone groups
+        amax = 255.0f/(amax == 0.0f ? 1.0f : amax);
+        for (int k = 0; k < m_rx.nSlotsFixed; ++k) {
+            const float * src = m_rx.spectrum.data() + m_rx.slotBinFixed[k];
+            uint8_t * dst = m_rx.spectrumFixed.data() + 16*k;
+            for (int i = 0; i < 16; ++i) {
+                dst[i] = GG_MIN(255.0f, GG_MAX(0.0f, (float) round(src[i]*amax)));
+            }
+        }
+    }
+
+    // update the tone votes with the new frame. the votes of the frame that is framesPerTx frames old are dropped,
+    // so voteCount holds the votes of the framesPerTx frames ending at the new one
+    const int nRows = m_rx.voteTone.size();
+    const int row   = m_rx.voteRow;
+
+    if (++m_rx.voteRow >= nRows) {
+        m_rx.voteRow = 0;
+    }
+
+    auto ringRow = [nRows](int r) { return r < 0 ? r + nRows : r; };
+
+    const int nProtocols = m_rx.protocols.size();
+
+    for (int protocolId = 0; protocolId < nProtocols; ++protocolId) {
+        const auto & protocol = m_rx.protocols[protocolId];
+
+        const int g0 = m_rx.voteGroupStart[protocolId];
+        const int g1 = m_rx.voteGroupStart[protocolId + 1];
+        if (g0 == g1) {
+            continue;
+        }
+
+        auto tones     = m_rx.voteTone[row];
+        auto tonesOld  = m_rx.voteTone[ringRow(row - protocol.framesPerTx)];
+        auto majority  = m_rx.voteMajority[row];
+        auto confident = m_rx.voteConfident[row];
+
+        int nDetected = 0;
+        for (int g = g0; g < g1; ++g) {
+            // 1 + tone, with kToneConfident set if the tone stands out
+            tones[g] = 0;
+            if (isGated == false && m_rx.voteGroupSlot[g] >= 0) {
+                const uint8_t * spectrum = m_rx.spectrumFixed.data() + 16*m_rx.voteGroupSlot[g];
+
+                float ratio = 0.0f;
+                tones[g] = 1 + ::argmax16(spectrum, ratio);
+                if (ratio >= kConfidencePeakRatio) {
+                    tones[g] |= kToneConfident;
+                }
+            }
+
+            uint8_t * count = m_rx.voteCount.data() + 16*g;
+            if (tonesOld[g] > 0) {
+                --count[(tonesOld[g] & ~kToneConfident) - 1];
+                m_rx.voteConfidentCount[g] -= (tonesOld[g] & kToneConfident) ? 1 : 0;
+            }
+            if (tones[g] > 0) {
+                ++count[(tones[g] & ~kToneConfident) - 1];
+                m_rx.voteConfidentCount[g] += (tones[g] & kToneConfident) ? 1 : 0;
+            }
+
+            confident[g] = m_rx.voteConfidentCount[g] > protocol.framesPerTx/2;
+
+            majority[g] = 0;
+            for (int b = 0; b < 16; ++b) {
+                if (count[b] > protocol.framesPerTx/2) {
+                    majority[g] = 1 + b;
+                    ++nDetected;
+                    break;
+                }
+            }
+        }
+
+        // the Txs of the window end at the rows row - m*framesPerTx, m = 0 .. totalTxs - 1. the detected groups of the
+        // Txs with complete bytes (m >= extra) are summed incrementally, the ones of the last byte group are counted below.
+        // the window depends on the payload length, so there is one sum per length
+        m_rx.voteDetected[row][protocolId] = nDetected;
+        for (int l = 0; l < m_nPayloadLengthsRx; ++l) {
+            const int totalLength = m_payloadLengthsRx[l] + getECCBytesForLength(m_payloadLengthsRx[l]);
+            const int totalTxs    = protocol.extra*((totalLength + protocol.bytesPerTx - 1)/protocol.bytesPerTx);
+
+            const int id = l*nProtocols + protocolId;
+            m_rx.voteDetectedSum[row][id] =
+                m_rx.voteDetectedSum[ringRow(row - protocol.framesPerTx)][id] +
+                m_rx.voteDetected[ringRow(row - protocol.extra*protocol.framesPerTx)][protocolId] -
+                m_rx.voteDetected[ringRow(row - totalTxs*protocol.framesPerTx)][protocolId];
+        }
+    }
+
+    m_rx.framesSinceLast = GG_MIN(m_rx.framesSinceLast + 1, nRows);
+
+    bool isValid = false;
+    for (int protocolId = 0; protocolId < nProtocols && isValid == false; ++protocolId) {
+        const auto & protocol = m_rx.protocols[protocolId];
+        if (protocol.enabled == false) {
+            continue;
         }
 
-        if (txDetectedTotal < 0.75*txNeededTotal) {
-            detectedSignal = false;
+        const int g0 = m_rx.voteGroupStart[protocolId];
+        const int g1 = m_rx.voteGroupStart[protocolId + 1];
+        if (g0 == g1 || protocol.freqStart > m_rx.samplesPerFrame) {
+            continue;
         }
 
-        if (detectedSignal) {
-            RS::ReedSolomon rsData(m_payloadLength, getECCBytesForLength(m_payloadLength), m_workRSData.data());
+        for (int l = 0; l < m_nPayloadLengthsRx && isValid == false; ++l) {
+            const int payloadLength = m_payloadLengthsRx[l];
+            const int totalLength   = payloadLength + getECCBytesForLength(payloadLength);
+            const int totalTxs      = protocol.extra*((totalLength + protocol.bytesPerTx - 1)/protocol.bytesPerTx);
+
+            // byte and nibble of group g in Tx k
+            auto nibbleId = [&](int k, int g) {
+                return protocol.extra == 1 ?
+                    2*(k*protocol.bytesPerTx + (g - g0)/2) + (g - g0)%2 :
+                    2*((k/2)*protocol.bytesPerTx + (g - g0)) + k%2;
+            };
+
+            int txDetectedTotal = m_rx.voteDetectedSum[row][l*nProtocols + protocolId];
+            for (int k = totalTxs - protocol.extra; k < totalTxs; ++k) {
+                const auto majority = m_rx.voteMajority[ringRow(row - (totalTxs - 1 - k)*protocol.framesPerTx)];
+                for (int g = g0; g < g1; ++g) {
+                    if (nibbleId(k, g) < 2*totalLength && majority[g] > 0) {
+                        ++txDetectedTotal;
+                    }
+                }
+            }
+
+            if (txDetectedTotal < 0.75*2*totalLength) {
+                continue;
+            }
+
+            // a shorter payload followed by a few more bytes. the RS generator does not depend on the length, so
+            // the decoder would often accept it
+            const int window = totalTxs*protocol.framesPerTx;
+            if (protocolId == m_rx.lastProtocolId && payloadLength > m_rx.lastLength &&
+                m_rx.framesSinceLast + m_rx.lastWindow <= window) {
+                continue;
+            }
+
+            ++m_rx.statsFixed.nCandidates;
 
             for (int j = 0; j < totalLength; ++j) {
-                m_dataEncoded[j] = (m_rx.detectedBins[2*j + 1] << 4) + m_rx.detectedBins[2*j + 0];
+                m_dataEncoded[j] = 0;
+                m_rx.nibblesDetected[j]  = 0;
+                m_rx.nibblesConfident[j] = 0;
+            }
+
+            for (int k = 0; k < totalTxs; ++k) {
+                const int r = ringRow(row - (totalTxs - 1 - k)*protocol.framesPerTx);
+                const auto majority  = m_rx.voteMajority[r];
+                const auto confident = m_rx.voteConfident[r];
+                for (int g = g0; g < g1; ++g) {
+                    const int id = nibbleId(k, g);
+                    if (id < 2*totalLength && majority[g] > 0) {
+                        m_dataEncoded[id/2] |= (majority[g] - 1) << (4*(id%2));
+                        m_rx.nibblesDetected[id/2]  += 1;
+                        m_rx.nibblesConfident[id/2] += confident[g];
+                    }
+                }
+            }
+
+            // staged acceptance: the bytes with a missing nibble are passed to Reed-Solomon as erasures, followed by
+            // the ones with an unclear tone up to half of the ECC bytes. an erasure costs one ECC byte instead of the
+            // two of an error at an unknown position, but a correction may change at most nChangedMax bytes, erased
+            // or not, so candidates with more missing bytes cannot be accepted. an error-free candidate needs only
+            // the syndromes
+            const int nECC        = getECCBytesForLength(payloadLength);
+            const int nChangedMax = nECC/2 + kErasureExtraBytes;
+
+            int nErasures = 0;
+            for (int j = 0; j < totalLength && nErasures <= nChangedMax; ++j) {
+                if (m_rx.nibblesDetected[j] < 2) {
+                    if (nErasures < nChangedMax) {
+                        m_rx.erasures[nErasures] = j;
+                    }
+                    ++nErasures;
+                }
+            }
+
+            if (nErasures > nChangedMax) {
+                ++m_rx.statsFixed.nUnfixable;
+                continue;
+            }
+
+            for (int j = 0; j < totalLength && nErasures < nECC/2; ++j) {
+                if (m_rx.nibblesDetected[j] == 2 && m_rx.nibblesConfident[j] < 2) {
+                    m_rx.erasures[nErasures++] = j;
+                }
+            }
+
+            RS::ReedSolomon rsData(payloadLength, nECC, m_workRSData.data());
+
+            bool isDecoded = false;
+            if (rsData.Check(m_dataEncoded.data())) {
+                ++m_rx.statsFixed.nSyndromeOk;
+
+                memcpy(m_rx.data.data(), m_dataEncoded.data(), payloadLength);
+                isDecoded = true;
+            } else {
+                ++m_rx.statsFixed.nCorrections;
+
+                if (rsData.Decode(m_dataEncoded.data(), m_rx.data.data(), m_rx.erasures.data(), nErasures) == 0) {
+                    // count the changed bytes on the re-encoded codeword. the erased ones count as changed
+                    rsData.EncodeBlock(m_rx.data.data(), m_rx.eccDecoded.data());
+
+                    auto decoded = [&](int j) { return j < payloadLength ? m_rx.data[j] : m_rx.eccDecoded[j - payloadLength]; };
+
+                    int nChanged = nErasures;
+                    for (int j = 0; j < totalLength; ++j) {
+                        nChanged += decoded(j) != m_dataEncoded[j];
+                    }
+                    for (int k = 0; k < nErasures; ++k) {
+                        nChanged -= decoded(m_rx.erasures[k]) != m_dataEncoded[m_rx.erasures[k]];
+                    }
+
+                    if (nChanged <= nChangedMax) {
+                        ++m_rx.statsFixed.nCorrected;
+                        isDecoded = true;
+                    }
+                }
             }
 
-            if (rsData.Decode(m_dataEncoded.data(), m_rx.data.data()) == 0) {
+            if (isDecoded) {
                 if (m_isDSSEnabled) {
-                    for (int i = 0; i < m_payloadLength; ++i) {
+                    for (int i = 0; i < payloadLength; ++i) {
                         m_rx.data[i] = m_rx.data[i] ^ getDSSMagic(i);
                     }
                 }
 
-                ggprintf("Decoded length = %d, protocol = '%s' (%d)\n", m_payloadLength, protocol.name, protocolId);
+                // the previous payload may have been longer
+                m_rx.data[payloadLength] = 0;
+
+                ggprintf("Decoded length = %d, protocol = '%s' (%d)\n", payloadLength, protocol.name, protocolId);
                 ggprintf("Received sound data successfully: '%s'\n", m_rx.data.data());
 
                 isValid = true;
                 m_rx.hasNewRxData = true;
-                m_rx.dataLength = m_payloadLength;
+                m_rx.dataLength = payloadLength;
                 m_rx.protocol = protocol;
                 m_rx.protocolId = RxProtocolId(protocolId);
-            }
-        }
 
-        if (isValid) {
-            break;
+                m_rx.lastProtocolId  = protocolId;
+                m_rx.lastLength      = payloadLength;
+                m_rx.lastWindow      = window;
+                m_rx.framesSinceLast = 0;
+            }
         }
     }
 }
@@ -2096,8 +3899,77 @@ int GGWave::maxTonesPerTx(const Protocols & protocols) const {
     return res;
 }
 
+void GGWave::planRxFrontEnd() {
+    const auto & protocols = Protocols::rx();
+
+    const int N  = m_samplesPerFrame;
+    const int b0 = minFreqStart(protocols);
+    const int b1 = maxFreqEnd(protocols);
+
+    if (b0 >= b1 || 2*b1 > N) {
+        if (m_isRxHeterodyne) {
+            ggprintf("Rx front end: the Rx protocol bins %d - %d do not fit below the Nyquist frequency - not decimating\n", b0, b1);
+        }
+        return;
+    }
+
+    // low-pass: the filter passes the bins below b1. after the decimation to N/D samples, the bins at
+    // N/D - b1 and above alias onto the band. the bins stay in place
+    for (int D = 2; N % D == 0 && N/D >= kFrontEndMinSamplesPerFrame; D *= 2) {
+        const int nd   = N/D;
+        const int stop = nd - b1;
+        if (stop <= b1) {
+            break;
+        }
+
+        // the transition band of a Hann-windowed sinc is about 3.1/nTaps wide. nTaps is a multiple of D
+        const int nTaps = D*((31*N + 10*D*(stop - b1) - 1)/(10*D*(stop - b1)));
+        if (nTaps > kFrontEndMaxTaps) {
+            break;
+        }
+
+        m_rx.samplesPerFrame = nd;
+        m_rx.decimation      = D;
+        m_rx.frontEndTaps    = nTaps;
+        m_rx.frontEndCutoff  = 0.5f*(b1 + stop)/N;
+    }
+
+    if (m_isRxHeterodyne == false) {
+        return;
+    }
+
+    // heterodyne: the filter passes the bins |bin - bc| <= w. after the decimation to N/D samples and the mixing,
+    // the bins at |bin - bc| >= N/D/2 - w alias onto the band, and so does the mirror image of the band at -b1 .. -b0
+    const int bc = (b0 + b1)/2;
+    const int w  = GG_MAX(b1 - bc, bc - b0);
+
+    for (int D = 2*m_rx.decimation; N % D == 0 && N/D >= kFrontEndMinSamplesPerFrame; D *= 2) {
+        const int nd   = N/D;
+        const int stop = GG_MIN(nd/2 - w, GG_MIN(N - b1 - bc, b0 + bc));
+        if (stop <= w) {
+            break;
+        }
+
+        const int nTaps = D*((31*N + 10*D*(stop - w) - 1)/(10*D*(stop - w)));
+        if (nTaps > kFrontEndMaxTaps) {
+            break;
+        }
+
+        m_rx.samplesPerFrame = nd;
+        m_rx.decimation      = D;
+        m_rx.isHeterodyne    = true;
+        m_rx.binShift        = bc - nd/4;
+        m_rx.frontEndTaps    = nTaps;
+        m_rx.frontEndCutoff  = 0.5f*(w + stop)/N;
+    }
+
+    if (m_rx.decimation == 1) {
+        ggprintf("Rx front end: the Rx protocol bins %d - %d need more than %d filter taps - not decimating\n", b0, b1, kFrontEndMaxTaps);
+    }
+}
+
 int GGWave::minFreqStart(const Protocols & protocols) const {
-    int res = m_samplesPerFrame;
+    int res = m_rx.samplesPerFrame;
     for (int i = 0; i < protocols.size(); ++i) {
         const auto & protocol = protocols[i];
         if (protocol.enabled == false) {
@@ -2108,6 +3980,52 @@ int GGWave::minFreqStart(const Protocols & protocols) const {
     return res;
 }
 
+int GGWave::maxFreqEnd(const Protocols & protocols) const {
+    int res = 0;
+    for (int i = 0; i < protocols.size(); ++i) {
+        const auto & protocol = protocols[i];
+        if (protocol.enabled == false) {
+            continue;
+        }
+        res = GG_MAX(res, protocol.freqStart + 2*16*protocol.bytesPerTx);
+    }
+    return GG_MIN(res, m_rx.samplesPerFrame);
+}
+
 double GGWave::bitFreq(const Protocol & p, int bit) const {
     return m_hzPerSample*p.freqStart + m_freqDelta_hz*bit;
 }
+
+int GGWave::nMarkerBits(const Spectrum & spectrum, const Protocol & protocol, bool isStart) const {
+    int res = 0;
+    for (int i = 0; i < m_nBitsInMarker; ++i) {
+        double freq = bitFreq(protocol, i);
+        int bin = round(freq*m_ihzPerSample);
+
+        // the start marker has the even bits on the lower and the odd bits on the upper bin, the end marker - vice versa
+        if ((i%2 == 0) == isStart) {
+            if (spectrum[bin] > m_soundMarkerThreshold*spectrum[bin + m_freqDelta_bin]) ++res;
+        } else {
+            if (spectrum[bin] < m_soundMarkerThreshold*spectrum[bin + m_freqDelta_bin]) ++res;
+        }
+    }
+    return res;
+}
+
+void GGWave::recordedSpectrum(int slot, int offset, int nFrames) {
+    const auto recording = m_rx.amplitudeRecorded[slot];
+
+    memcpy(m_analysis.fftOut.data(),
+           recording.data() + offset,
+           m_rx.samplesPerFrame*sizeof(float));
+
+    for (int k = 1; k < nFrames; ++k) {
+        for (int i = 0; i < m_rx.samplesPerFrame; ++i) {
+            m_analysis.fftOut[i] += recording[offset + k*m_rx.samplesPerFrame + i];
+        }
+    }
+
+    FFT(*m_fftBackend, m_analysis.fftOut.data(), m_rx.samplesPerFrame, m_analysis.fftWorkI.data(), m_analysis.fftWorkF.data());
+
+    ::powerSpectrum(m_analysis.fftOut.data(), m_analysis.spectrum.data(), m_rx.samplesPerFrame, m_rx.binStart, m_rx.binEnd);
+}
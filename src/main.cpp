@@ -31,12 +31,14 @@ void signalHandler(int signum) {
 int main(int argc, char** argv) {
 
     signal(SIGINT, signalHandler);
-    printf("Usage: %s [-cN] [-pN] [-tN] [-lN] [-r] [-s filename] [-f filename]\n", argv[0]);
+    printf("Usage: %s [-cN] [-pN] [-tN] [-lN] [-n] [-a] [-r] [-s filename] [-f filename]\n", argv[0]);
     printf("    -cN - select capture device N\n");
     printf("    -pN - select playback device N\n");
     printf("    -tN - transmission protocol\n");
     printf("    -lN - fixed payload length of size N, N in [1, %d]\n", GGWave::kMaxLengthFixed);
     printf("    -d  - use Direct Sequence Spread (DSS)\n");
+    printf("    -n  - open the audio devices at their native sample rate (short Rx resampling filter)\n");
+    printf("    -a  - analyze the received data on a separate thread (needs more memory)\n");
     printf("    -v  - print generated tones on resend\n");
     printf("    -r  - receive only mode (disable transmission)\n");
     printf("    -s filename - save encoded waveform to file (for testing)\n");
@@ -49,6 +51,8 @@ int main(int argc, char** argv) {
     const int  txProtocolId  = argm.count("t") == 0 ?  0 : std::stoi(argm.at("t"));
     const int  payloadLength = argm.count("l") == 0 ? -1 : std::stoi(argm.at("l"));
     const bool useDSS        = argm.count("d") >  0;  //强制启动DSS：直接序列扩频(DSS)技术
+    const bool nativeRate    = argm.count("n") >  0;
+    const bool asyncAnalysis = argm.count("a") >  0;
     const bool printTones    = argm.count("v") >  0;
     const bool receiveOnly   = argm.count("r") >  0;
     const bool saveToFile    = argm.count("s") >  0;
@@ -70,7 +74,7 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (GGWave_init(playbackId, captureId, payloadLength, 0.0f, useDSS) == false) {
+    if (GGWave_init(playbackId, captureId, payloadLength, 0.0f, useDSS, nativeRate, asyncAnalysis) == false) {
         fprintf(stderr, "Failed to initialize GGWave\n");
         return -1;
     }
@@ -203,15 +207,25 @@ int main(int argc, char** argv) {
                         fflush(stdout);
                         
                         if (waveformSize > 0) {
-                            printf("Step 2: Calling encode()...\n");
+                            printf("Step 2: Calling encodeFrame()...\n");
                             fflush(stdout);
                             
-                            uint32_t encodedSize = ggWave->encode();
-                            printf("Step 3: encode() returned %u bytes\n", encodedSize);
+                            std::vector<uint8_t> encoded(waveformSize);
+                            std::vector<uint8_t> frame(ggWave->encodeFrameSize_bytes());
+                            uint32_t encodedSize = 0;
+                            while (ggWave->txHasData()) {
+                                const uint32_t nBytes = ggWave->encodeFrame(frame.data());
+                                if (encodedSize + nBytes > encoded.size()) {
+                                    encoded.resize(encodedSize + nBytes);
+                                }
+                                std::memcpy(encoded.data() + encodedSize, frame.data(), nBytes);
+                                encodedSize += nBytes;
+                            }
+                            printf("Step 3: encodeFrame() produced %u bytes\n", encodedSize);
                             fflush(stdout);
                             
-                            const void * waveform = ggWave->txWaveform();
-                            printf("Step 4: txWaveform() returned %p\n", waveform);
+                            const void * waveform = encoded.data();
+                            printf("Step 4: waveform at %p\n", waveform);
                             fflush(stdout);
                             
                             uint32_t actualSize = waveformSize;
@@ -296,9 +310,10 @@ int main(int argc, char** argv) {
                                         GGWave::Parameters parameters = ggWave->getDefaultParameters();
                                         parameters.operatingMode = GGWAVE_OPERATING_MODE_RX;
                                         parameters.payloadLength = payloadLength;
-                                        parameters.sampleRateInp = 44100.0f;
-                                        parameters.sampleRateOut = 44100.0f;
+                                        parameters.sampleRateInp = nativeRate ? ggWave->sampleRateOut() : 44100.0f;
+                                        parameters.sampleRateOut = parameters.sampleRateInp;
                                         parameters.sampleRate = 44100.0f;
+                                        if (nativeRate) parameters.operatingMode |= GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER;
                                         parameters.samplesPerFrame = 1024;
                                         parameters.soundMarkerThreshold = 1.0f;
                                         parameters.sampleFormatInp = GGWave::SampleFormat::GGWAVE_SAMPLE_FORMAT_I16;
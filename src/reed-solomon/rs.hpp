@@ -17,7 +17,7 @@
 namespace RS {
 
 #define MSG_CNT 3   // message-length polynomials count
-#define POLY_CNT 14 // (ecc_length*2)-length polynomialc count
+#define POLY_CNT 14 // (ecc_length*2 + 2)-length polynomialc count
 
 class ReedSolomon {
 public:
@@ -31,7 +31,13 @@ public:
 
     // used to pre-allocate a memory buffer for the Reed-Solomon class in order to avoid memory allocations
     static size_t getWorkSize_bytes(uint8_t msg_length, uint8_t ecc_length) {
-        return ecc_length + 1 + MSG_CNT * msg_length + POLY_CNT * ecc_length * 2;
+        return ecc_length + 1 + MSG_CNT * (msg_length + ecc_length) + POLY_CNT * getPolyLength(ecc_length);
+    }
+
+    // gg : the product of the syndromes and the errata locator has up to 2*ecc_length + 1 coefficients when
+    // erasures are corrected together with errors
+    static uint8_t getPolyLength(uint8_t ecc_length) {
+        return ecc_length * 2 + 2;
     }
 
     ReedSolomon(uint8_t msg_length_p, uint8_t ecc_length_p, uint8_t * heap_memory_p = nullptr) :
@@ -46,7 +52,7 @@ public:
         generator_cache = heap_memory;
 
         const uint8_t   enc_len  = msg_length + ecc_length;
-        const uint8_t   poly_len = ecc_length * 2;
+        const uint8_t   poly_len = getPolyLength(ecc_length);
         uint8_t** memptr   = &memory;
         uint16_t  offset   = 0;
 
@@ -213,10 +219,16 @@ public:
         }
 
         // Going to exit if no errors
-        if(!has_errors) goto return_corrected_msg;
+        // gg : with erasures, the message with the erased bytes set to 0 is the valid one
+        if(!has_errors) {
+            msg_out->Copy(msg_in);
+            goto return_corrected_msg;
+        }
 
         CalcForneySyndromes(synd, epos, src_len);
-        FindErrorLocator(forney, NULL, epos->length);
+
+        // gg : too many errors for the remaining ECC bytes
+        if(!FindErrorLocator(forney, NULL, epos->length)) return 1;
 
         // Reversing syndrome
         // TODO optimize through special Poly flag
@@ -230,16 +242,28 @@ public:
         if(!ok) return 1;
 
         // Error happened while finding errors (so helpfull :D)
-        if(err->length == 0) return 1;
+        // gg : unless the erasures alone explain the syndromes
+        if(err->length == 0 && epos->length == 0) return 1;
 
         /* Adding found errors with known */
+        // gg : an error at an erased position means the locator is wrong (too many errors). the correction would
+        // divide by zero
         for(uint8_t i = 0; i < err->length; i++) {
+            for(uint8_t j = 0; j < erase_count; j++) {
+                if(epos->at(j) == err->at(i)) return 1;
+            }
             epos->Append(err->at(i));
         }
 
         // Correcting errors
         CorrectErrata(synd, epos, msg_in);
 
+        // gg : beyond the correction capacity the locator can produce a word that is not a codeword
+        CalcSyndromes(msg_out);
+        for(uint8_t i = 0; i < synd->length; i++) {
+            if(synd->at(i) != 0) return 1;
+        }
+
     return_corrected_msg:
         // Wrighting corrected message to output buffer
         msg_out->length = dst_len;
@@ -260,6 +284,26 @@ public:
          return DecodeBlock(src, ecc_ptr, dst, erase_pos, erase_count);
      }
 
+    /* @brief Syndrome-only check of an encoded message, without correction
+     * gg : cheap test before a full Decode()
+     * @param *src         - encoded message buffer   (msg_length + ecc_length size)
+     * @return true if the message has no errors */
+     bool Check(const void* src) const {
+         const uint8_t *src_ptr = (const uint8_t*) src;
+         const uint8_t src_len = msg_length + ecc_length;
+
+         // same evaluation as CalcSyndromes()
+         for(uint8_t i = 0; i < ecc_length; i++) {
+             const uint8_t x = gf::pow(2, i);
+             uint8_t y = src_ptr[0];
+             for(uint8_t j = 1; j < src_len; j++) {
+                 y = gf::mul(y, x) ^ src_ptr[j];
+             }
+             if(y != 0) return false;
+         }
+         return true;
+     }
+
 #ifndef DEBUG
 private:
 #endif
@@ -493,8 +537,11 @@ private:
         uint32_t shift = 0;
         while(err_loc->length && err_loc->at(shift) == 0) shift++;
 
+        // gg : with the Forney syndromes (erase_loc == NULL) the locator holds only the errors. the difference
+        // used to wrap around when there were fewer errors than erasures
         uint32_t errs = err_loc->length - shift - 1;
-        if(((errs - erase_count) * 2 + erase_count) > ecc_length){
+        if(erase_loc != NULL) errs -= erase_count;
+        if((errs * 2 + erase_count) > ecc_length){
             return false; /* Error count is greater then we can fix! */
         }
 
@@ -0,0 +1,645 @@
+#include "ggwave.h"
+
+// the kernels checked against their references have internal linkage, so the implementation is built into this file
+#include "../src/ggwave.cpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// round trips through a device running at a rate different from the operating one: the Tx waveform is resampled
+// to the device rate, and the capture back with the default input resampler or GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER.
+// an ultrasound band at 96 kHz is received through GGWAVE_OPERATING_MODE_RX_HETERODYNE
+//
+// the fixed-length decoder is also run on transmissions buried in white noise and on noise alone. the expected
+// counts are what the decoder detected before the uncertain bytes were passed to Reed-Solomon as erasures
+//
+// the vectorized FFT backends are compared with Ooura's rdft(), argmax16() and the 16-bit sample conversion
+// kernels with scalar loops, and the resampler with the windowed-sinc filter evaluated per tap in double precision
+
+namespace {
+
+const char * kMessage = "hello world";
+
+GGWave::Parameters parameters(float deviceRate, float sampleRate, int payloadLength) {
+    auto res = GGWave::getDefaultParameters();
+
+    res.payloadLength   = payloadLength;
+    res.sampleRateInp   = deviceRate;
+    res.sampleRateOut   = deviceRate;
+    res.sampleRate      = sampleRate;
+    res.sampleFormatInp = GGWAVE_SAMPLE_FORMAT_F32;
+    res.sampleFormatOut = GGWAVE_SAMPLE_FORMAT_F32;
+    res.operatingMode   = 0;
+
+    return res;
+}
+
+// rxMode - extra operating mode of the receiver. rxSamplesPerFrame, if not null, receives the frame size that the
+// receiver analyzes
+bool roundTrip(GGWave::TxProtocolId protocolId, float deviceRate, float sampleRate, int payloadLength, int rxMode,
+               int * rxSamplesPerFrame = nullptr) {
+    auto pTx = parameters(deviceRate, sampleRate, payloadLength);
+    pTx.operatingMode |= GGWAVE_OPERATING_MODE_TX;
+
+    GGWave tx(pTx);
+    if (tx.init(kMessage, protocolId, 25) == false) {
+        return false;
+    }
+
+    const int nBytes = tx.encode();
+    if (nBytes <= 0) {
+        return false;
+    }
+
+    // silence around the transmission, as captured by a microphone
+    const int nSilence = 20*GGWave::kDefaultSamplesPerFrame;
+
+    std::vector<float> waveform(nSilence, 0.0f);
+    const float * samples = (const float *) tx.txWaveform();
+    waveform.insert(waveform.end(), samples, samples + nBytes/sizeof(float));
+    waveform.resize(waveform.size() + 2*nSilence, 0.0f);
+
+    auto pRx = parameters(deviceRate, sampleRate, payloadLength);
+    pRx.operatingMode |= GGWAVE_OPERATING_MODE_RX | rxMode;
+
+    GGWave rx(pRx);
+    if (rxSamplesPerFrame) {
+        *rxSamplesPerFrame = rx.rxSamplesPerFrame();
+    }
+
+    std::string received;
+    GGWave::TxRxData data;
+
+    const int nChunk = GGWave::kDefaultSamplesPerFrame;
+    for (size_t i = 0; i < waveform.size(); i += nChunk) {
+        const size_t n = std::min(waveform.size() - i, (size_t) nChunk);
+        rx.decode(waveform.data() + i, n*sizeof(float));
+
+        const int nData = rx.rxTakeData(data);
+        if (nData > 0) {
+            received.assign((const char *) data.data(), nData);
+            break;
+        }
+    }
+
+    const std::string expected = payloadLength > 0 ? std::string(kMessage, payloadLength) : std::string(kMessage);
+
+    return received == expected;
+}
+
+// fixed-length Tx at the device rate, Gaussian noise with the given seed, fixed-length Rx with the extra operating mode
+bool decodeInNoise(GGWave::TxProtocolId protocolId, float sigma, int seed, int rxMode) {
+    const int payloadLength = 8;
+
+    auto p = parameters(96000.0f, GGWave::kDefaultSampleRate, payloadLength);
+    p.operatingMode = GGWAVE_OPERATING_MODE_TX;
+
+    GGWave tx(p);
+    if (tx.init(kMessage, protocolId, 25) == false) {
+        return false;
+    }
+
+    const int nBytes = tx.encode();
+    if (nBytes <= 0) {
+        return false;
+    }
+
+    const int nSilence = 20*3*GGWave::kDefaultSamplesPerFrame;
+
+    std::vector<float> waveform(nSilence, 0.0f);
+    const float * samples = (const float *) tx.txWaveform();
+    waveform.insert(waveform.end(), samples, samples + nBytes/sizeof(float));
+    waveform.resize(2*waveform.size(), 0.0f);
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, sigma);
+    for (auto & v : waveform) {
+        v += noise(rng);
+    }
+
+    p.operatingMode = GGWAVE_OPERATING_MODE_RX | rxMode;
+
+    GGWave rx(p);
+
+    bool ok = false;
+    GGWave::TxRxData data;
+
+    const int nChunk = GGWave::kDefaultSamplesPerFrame;
+    for (size_t i = 0; i + nChunk <= waveform.size(); i += nChunk) {
+        rx.decode(waveform.data() + i, nChunk*sizeof(float));
+
+        if (rx.rxTakeData(data) == payloadLength && memcmp(data.data(), kMessage, payloadLength) == 0) {
+            ok = true;
+        }
+    }
+
+    return ok;
+}
+
+// number of payloads decoded from pure noise
+int falseDecodes(int payloadLength, float sigma, int nFrames) {
+    auto p = parameters(GGWave::kDefaultSampleRate, GGWave::kDefaultSampleRate, payloadLength);
+    p.operatingMode = GGWAVE_OPERATING_MODE_RX;
+
+    GGWave rx(p);
+
+    std::mt19937 rng(payloadLength);
+    std::normal_distribution<float> noise(0.0f, sigma);
+
+    int res = 0;
+    GGWave::TxRxData data;
+
+    std::vector<float> frame(GGWave::kDefaultSamplesPerFrame);
+    for (int i = 0; i < nFrames; ++i) {
+        for (auto & v : frame) {
+            v = noise(rng);
+        }
+        rx.decode(frame.data(), frame.size()*sizeof(float));
+
+        if (rx.rxTakeData(data) > 0) {
+            ++res;
+        }
+    }
+
+    return res;
+}
+
+// largest difference between the transforms of random data computed by an FFT backend and by Ooura's rdft(),
+// relative to the largest output value. each backend transforms twice with the same work buffers, so that both
+// the table setup and the cached tables are used
+float fftError(const GGWave::FFTBackend & backend, int N, int isgn) {
+    const auto & reference = GGWave::fftBackendOoura();
+
+    std::vector<int>   wi(backend.workSizeI(N), 0);
+    std::vector<float> wf(backend.workSizeF(N), 0.0f);
+
+    std::vector<int>   wiRef(reference.workSizeI(N), 0);
+    std::vector<float> wfRef(reference.workSizeF(N), 0.0f);
+
+    std::mt19937 rng(N);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    float res = 0.0f;
+
+    std::vector<float> a(N);
+    std::vector<float> ref(N);
+    for (int iter = 0; iter < 2; ++iter) {
+        for (int i = 0; i < N; ++i) {
+            a[i] = ref[i] = value(rng);
+        }
+
+        backend.rdft(N, isgn, a.data(), wi.data(), wf.data());
+        reference.rdft(N, isgn, ref.data(), wiRef.data(), wfRef.data());
+
+        float maxRef  = 0.0f;
+        float maxDiff = 0.0f;
+        for (int i = 0; i < N; ++i) {
+            maxRef  = std::max(maxRef,  fabsf(ref[i]));
+            maxDiff = std::max(maxDiff, fabsf(a[i] - ref[i]));
+        }
+
+        res = std::max(res, maxDiff/maxRef);
+    }
+
+    return res;
+}
+
+// scalar argmax over 16 bins: the last of equal maxima for the quantized bins, the first one for the float bins
+template <typename T>
+int argmax16Scalar(const T * v, float & ratio) {
+    const bool isLast = sizeof(T) == 1;
+
+    int res = 0;
+    for (int b = 1; b < 16; ++b) {
+        if (v[b] > v[res] || (isLast && v[b] == v[res])) {
+            res = b;
+        }
+    }
+
+    T second = 0;
+    for (int b = 0; b < 16; ++b) {
+        if (b != res && second < v[b]) {
+            second = v[b];
+        }
+    }
+
+    ratio = ::peakRatio(v[res], second);
+
+    return res;
+}
+
+// number of random bin vectors for which argmax16() and the scalar loop give a different index or ratio. nValues
+// limits the number of distinct bin values, so that there are ties, 0 draws the full range. the bins are read
+// from unaligned addresses
+template <typename T>
+int argmax16Mismatches(int nValues, int nVectors) {
+    std::mt19937 rng(nValues);
+    std::uniform_int_distribution<int> value(0, nValues > 0 ? nValues - 1 : 255);
+    std::uniform_real_distribution<float> valueF32(0.0f, 1.0f);
+
+    std::vector<T> v(17);
+
+    int res = 0;
+    for (int i = 0; i < nVectors; ++i) {
+        for (int b = 1; b < 17; ++b) {
+            v[b] = (sizeof(T) == 1 || nValues > 0) ? T(value(rng)) : T(valueF32(rng));
+        }
+
+        float ratio    = 0.0f;
+        float ratioRef = 0.0f;
+
+        const int k    = ::argmax16(v.data() + 1, ratio);
+        const int kRef = argmax16Scalar(v.data() + 1, ratioRef);
+
+        res += (k == kRef && ratio == ratioRef) ? 0 : 1;
+    }
+
+    return res;
+}
+
+// number of samples that a pair of 16-bit conversion kernels converts differently from i16ToF32() / f32ToI16().
+// all 16-bit values are converted, signed and unsigned, and floats in and out of the range [-1, 1]. the 16-bit
+// buffers start at an odd address and the lengths are not multiples of the vector widths
+int sampleKernelMismatches(const SampleKernels & kernels) {
+    const int n = 65536 + 13;
+
+    std::vector<uint8_t> buf(2*n + 1);
+    uint8_t * p = buf.data() + 1;
+
+    for (int i = 0; i < n; ++i) {
+        const uint16_t v = i;
+        memcpy(p + 2*i, &v, sizeof(v));
+    }
+
+    int res = 0;
+
+    std::vector<float> f32(n);
+    for (uint16_t flip : { 0x0000, 0x8000 }) {
+        kernels.i16ToF32(p, f32.data(), n, flip);
+        for (int i = 0; i < n; ++i) {
+            res += f32[i] == ::i16ToF32(p + 2*i, flip) ? 0 : 1;
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> value(-1.25f, 1.25f);
+    for (auto & v : f32) {
+        v = value(rng);
+    }
+
+    const float edges[] = {
+        -1.0f, 1.0f, 0.0f, -0.0f, 32767.0f/32768, 32767.5f/32768, -32768.5f/32768, 0.5f/32768, -0.5f/32768,
+    };
+    for (int i = 0; i < (int) (sizeof(edges)/sizeof(edges[0])); ++i) {
+        f32[3*i + 1] = edges[i];
+    }
+
+    kernels.f32ToI16(f32.data(), p, n);
+    for (int i = 0; i < n; ++i) {
+        uint8_t ref[2];
+        ::f32ToI16(f32[i], ref);
+        res += memcmp(p + 2*i, ref, sizeof(ref)) == 0 ? 0 : 1;
+    }
+
+    return res;
+}
+
+// windowed-sinc tap at distance d input samples, with the cutoff lowered by scale when downsampling
+double sincTap(double d, double scale, int width) {
+    if (fabs(d) >= width) {
+        return 0.0;
+    }
+
+    const double x   = M_PI*scale*d;
+    const double win = 0.5 + 0.5*cos(M_PI*d/width);
+
+    return (x == 0.0 ? 1.0 : sin(x)/x)*scale*win;
+}
+
+// largest difference between the output of GGWave::Resampler and the per-tap filter, for a sum of three tones
+// below the lower Nyquist frequency. the input is fed in chunks of varying size, some of them longer than the
+// internal block of the resampler. returns a negative value if the number of outputs is not the predicted one
+float resamplerError(float rateInp, float rateOut, int width) {
+    GGWave::Resampler resampler;
+
+    int n = 0;
+    resampler.alloc(rateInp, rateOut, nullptr, n, width);
+
+    std::vector<float> heap(n/sizeof(float) + 1);
+
+    n = 0;
+    resampler.alloc(rateInp, rateOut, heap.data(), n, width);
+
+    const int nInp = 12000;
+
+    // tone frequencies in cycles per input sample, relative to the lower of the two rates
+    const double f = std::min(rateInp, rateOut)/rateInp;
+
+    std::vector<float> inp(nInp);
+    for (int i = 0; i < nInp; ++i) {
+        inp[i] = (sin(2.0*M_PI*0.05*f*i) + sin(2.0*M_PI*0.17*f*i + 1.0) + sin(2.0*M_PI*0.31*f*i + 2.0))/3.0;
+    }
+
+    std::vector<float> out;
+    std::vector<float> chunk;
+
+    const int chunkSizes[] = { 1, 7, 100, 5000, 513, 64, 2999 };
+
+    for (int i = 0, k = 0; i < nInp; ++k) {
+        const int nChunk = std::min(nInp - i, chunkSizes[k % 7]);
+        const int nOut   = resampler.nSamplesOut(nChunk);
+
+        chunk.resize(nOut + 1);
+        if (resampler.resample(nChunk, inp.data() + i, chunk.data()) != nOut) {
+            return -1.0f;
+        }
+        out.insert(out.end(), chunk.begin(), chunk.begin() + nOut);
+
+        i += nChunk;
+    }
+
+    const double ratio = double(rateInp)/rateOut;
+    const double scale = std::min(1.0, 1.0/ratio);
+
+    double res = 0.0;
+    for (int k = 0; k < (int) out.size(); ++k) {
+        const double t = k*ratio;
+
+        double ref = 0.0;
+        for (int j = std::max(0, int(t) - width + 1); j <= int(t) + width && j < nInp; ++j) {
+            ref += inp[j]*sincTap(t - j, scale, width);
+        }
+
+        res = std::max(res, fabs(out[k] - ref));
+    }
+
+    return res;
+}
+
+}
+
+int main() {
+    GGWave::setLogFile(nullptr);
+
+    const GGWave::TxProtocolId protocolIds[] = {
+        GGWAVE_PROTOCOL_AUDIBLE_NORMAL,
+        GGWAVE_PROTOCOL_AUDIBLE_FAST,
+        GGWAVE_PROTOCOL_AUDIBLE_FASTEST,
+        GGWAVE_PROTOCOL_DT_NORMAL,
+        GGWAVE_PROTOCOL_DT_FAST,
+        GGWAVE_PROTOCOL_DT_FASTEST,
+        GGWAVE_PROTOCOL_MT_NORMAL,
+        GGWAVE_PROTOCOL_MT_FAST,
+        GGWAVE_PROTOCOL_MT_FASTEST,
+    };
+
+    int nFailed = 0;
+
+    for (float deviceRate : { 48000.0f, 96000.0f }) {
+        for (int payloadLength : { -1, 8 }) {
+            for (auto protocolId : protocolIds) {
+                // the MT protocols are not decoded in variable-length mode
+                if (payloadLength < 0 && protocolId >= GGWAVE_PROTOCOL_MT_NORMAL) {
+                    continue;
+                }
+
+                const bool okDefault = roundTrip(protocolId, deviceRate, GGWave::kDefaultSampleRate, payloadLength, 0);
+                const bool okFast    = roundTrip(protocolId, deviceRate, GGWave::kDefaultSampleRate, payloadLength,
+                                                 GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER);
+
+                printf("%5.0f Hz, protocol %2d, length %2d: default Rx resampler %s, fast Rx resampler %s\n",
+                       deviceRate, (int) protocolId, payloadLength, okDefault ? "ok" : "FAILED", okFast ? "ok" : "FAILED");
+
+                nFailed += (okDefault ? 0 : 1) + (okFast ? 0 : 1);
+            }
+        }
+    }
+
+    // the short filter attenuates most near the Nyquist frequency of the operating rate, so move a protocol to the
+    // top of the spectrum
+    {
+        const auto protocolId = GGWAVE_PROTOCOL_AUDIBLE_FAST;
+        const int freqStartOld = GGWave::Protocols::tx()[protocolId].freqStart;
+        const int freqStartTop = GGWave::kDefaultSamplesPerFrame/2 - 2*16*GGWave::Protocols::tx()[protocolId].bytesPerTx;
+
+        GGWave::Protocols::tx()[protocolId].freqStart = freqStartTop;
+        GGWave::Protocols::rx()[protocolId].freqStart = freqStartTop;
+
+        for (float deviceRate : { 48000.0f, 96000.0f }) {
+            for (int payloadLength : { -1, 8 }) {
+                const bool okFast = roundTrip(protocolId, deviceRate, GGWave::kDefaultSampleRate, payloadLength,
+                                              GGWAVE_OPERATING_MODE_RX_FAST_RESAMPLER);
+
+                printf("%5.0f Hz, protocol %2d at bin %d, length %2d: fast Rx resampler %s\n",
+                       deviceRate, (int) protocolId, freqStartTop, payloadLength, okFast ? "ok" : "FAILED");
+
+                nFailed += okFast ? 0 : 1;
+            }
+        }
+
+        GGWave::Protocols::tx()[protocolId].freqStart = freqStartOld;
+        GGWave::Protocols::rx()[protocolId].freqStart = freqStartOld;
+    }
+
+    // the default [U] protocols use bins 480 - 576, above the Nyquist frequency at any sample rate. moved down to
+    // 30 kHz at 96 kHz, they are received through the heterodyne front end, which decimates the frame
+    {
+        const auto protocolsTx = GGWave::Protocols::tx();
+        const auto protocolsRx = GGWave::Protocols::rx();
+
+        const int freqStartUltrasound = 320;
+
+        const GGWave::TxProtocolId ultrasoundIds[] = {
+            GGWAVE_PROTOCOL_ULTRASOUND_NORMAL,
+            GGWAVE_PROTOCOL_ULTRASOUND_FAST,
+            GGWAVE_PROTOCOL_ULTRASOUND_FASTEST,
+        };
+
+        for (auto protocolId : ultrasoundIds) {
+            GGWave::Protocols::tx()[protocolId].freqStart = freqStartUltrasound;
+            GGWave::Protocols::rx().only(protocolId);
+            GGWave::Protocols::rx()[protocolId].freqStart = freqStartUltrasound;
+
+            for (int payloadLength : { -1, 8 }) {
+                int rxSamplesPerFrame = 0;
+                const bool okRx = roundTrip(protocolId, 96000.0f, 96000.0f, payloadLength,
+                                            GGWAVE_OPERATING_MODE_RX_HETERODYNE, &rxSamplesPerFrame);
+                const bool ok = okRx && rxSamplesPerFrame < GGWave::kDefaultSamplesPerFrame;
+
+                printf("96000 Hz, protocol %2d at bin %d, length %2d: heterodyne Rx (%d samples per frame) %s\n",
+                       (int) protocolId, freqStartUltrasound, payloadLength, rxSamplesPerFrame, ok ? "ok" : "FAILED");
+
+                nFailed += ok ? 0 : 1;
+            }
+        }
+
+        GGWave::Protocols::tx() = protocolsTx;
+        GGWave::Protocols::rx() = protocolsRx;
+    }
+
+    struct NoiseCase {
+        GGWave::TxProtocolId protocolId;
+        float sigma;
+        int rxMode;
+        int nExpected;
+    };
+
+    // the energy gate must not hide transmissions that are quieter than the broadband noise
+    const NoiseCase noiseCases[] = {
+        { GGWAVE_PROTOCOL_AUDIBLE_NORMAL,  0.40f, 0, 6 },
+        { GGWAVE_PROTOCOL_AUDIBLE_FAST,    0.35f, 0, 5 },
+        { GGWAVE_PROTOCOL_AUDIBLE_FAST,    0.40f, 0, 1 },
+        { GGWAVE_PROTOCOL_AUDIBLE_FASTEST, 0.40f, 0, 3 },
+        { GGWAVE_PROTOCOL_AUDIBLE_NORMAL,  0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+        { GGWAVE_PROTOCOL_AUDIBLE_FAST,    0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+        { GGWAVE_PROTOCOL_AUDIBLE_FASTEST, 0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+        { GGWAVE_PROTOCOL_DT_NORMAL,       0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+        { GGWAVE_PROTOCOL_DT_FAST,         0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+        { GGWAVE_PROTOCOL_DT_FASTEST,      0.10f, GGWAVE_OPERATING_MODE_RX_ENERGY_GATE, 6 },
+    };
+
+    const int nSeeds = 6;
+
+    for (const auto & c : noiseCases) {
+        int nDecoded = 0;
+        for (int seed = 1; seed <= nSeeds; ++seed) {
+            nDecoded += decodeInNoise(c.protocolId, c.sigma, seed, c.rxMode) ? 1 : 0;
+        }
+
+        const bool ok = nDecoded >= c.nExpected;
+
+        printf("noise %.2f, protocol %2d%s: decoded %d/%d, expected at least %d %s\n",
+               c.sigma, (int) c.protocolId, c.rxMode ? " (energy gate)" : "", nDecoded, nSeeds, c.nExpected, ok ? "ok" : "FAILED");
+
+        nFailed += ok ? 0 : 1;
+    }
+
+    for (int payloadLength : { 4, 8, 16 }) {
+        const int nFrames = 20000;
+        const int nFalse = falseDecodes(payloadLength, 0.2f, nFrames);
+
+        printf("pure noise, length %2d: %d false decodes in %d frames %s\n",
+               payloadLength, nFalse, nFrames, nFalse == 0 ? "ok" : "FAILED");
+
+        nFailed += nFalse == 0 ? 0 : 1;
+    }
+
+    for (int nValues : { 1, 2, 4, 0 }) {
+        const int nVectors = 100000;
+
+        const int nMismatchesU8  = argmax16Mismatches<uint8_t>(nValues, nVectors);
+        const int nMismatchesF32 = argmax16Mismatches<float>(nValues, nVectors);
+
+        const bool ok = nMismatchesU8 == 0 && nMismatchesF32 == 0;
+
+        const std::string values = nValues > 0 ? std::to_string(nValues) + " bin values" : "full range";
+
+        printf("argmax16, %s: %d uint8 and %d float vectors differ from the scalar loop %s\n",
+               values.c_str(), nMismatchesU8, nMismatchesF32, ok ? "ok" : "FAILED");
+
+        nFailed += ok ? 0 : 1;
+    }
+
+    {
+        const GGWave::FFTBackend * fftBackends[2] = {};
+
+        int nBackends = 0;
+#if defined(GGWAVE_SIMD_SSE2) || defined(GGWAVE_SIMD_NEON)
+        fftBackends[nBackends++] = &kFFTBackendSIMD;
+#endif
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2")) {
+            fftBackends[nBackends++] = &kFFTBackendAVX2;
+        }
+#endif
+
+        for (int i = 0; i < nBackends; ++i) {
+            for (int isgn : { 1, -1 }) {
+                float err = 0.0f;
+                for (int N = 16; N <= 8192; N *= 2) {
+                    err = std::max(err, fftError(*fftBackends[i], N, isgn));
+                }
+
+                const bool ok = err <= 1e-5f;
+
+                printf("FFT backend %s, %s, N = 16 - 8192: max relative error %.2e %s\n",
+                       fftBackends[i]->name, isgn > 0 ? "forward" : "inverse", err, ok ? "ok" : "FAILED");
+
+                nFailed += ok ? 0 : 1;
+            }
+        }
+    }
+
+    {
+        struct {
+            const char * name;
+            SampleKernels kernels;
+        } sampleKernelCases[2] = {
+#if defined(GGWAVE_SIMD_SSE2)
+            { "sse2",   { convertI16ToF32, convertF32ToI16 } },
+#elif defined(GGWAVE_SIMD_NEON)
+            { "neon",   { convertI16ToF32, convertF32ToI16 } },
+#else
+            { "scalar", { convertI16ToF32, convertF32ToI16 } },
+#endif
+        };
+
+        int nCases = 1;
+#if defined(GGWAVE_SIMD_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2")) {
+            sampleKernelCases[nCases++] = { "avx2", { convertI16ToF32_AVX2, convertF32ToI16_AVX2 } };
+        }
+#endif
+
+        for (int i = 0; i < nCases; ++i) {
+            const int nMismatches = sampleKernelMismatches(sampleKernelCases[i].kernels);
+
+            printf("16-bit sample conversion, %s kernels: %d samples differ from the scalar conversion %s\n",
+                   sampleKernelCases[i].name, nMismatches, nMismatches == 0 ? "ok" : "FAILED");
+
+            nFailed += nMismatches == 0 ? 0 : 1;
+        }
+    }
+
+    struct ResamplerCase {
+        float rateInp;
+        float rateOut;
+        int width;
+        float tolerance;
+    };
+
+    // the ratios of the common device rates use exact filter phases, the others interpolated ones
+    const ResamplerCase resamplerCases[] = {
+        { 48000.0f,  44100.0f,  GGWave::Resampler::kWidth,     1e-5f },
+        { 44100.0f,  48000.0f,  GGWave::Resampler::kWidth,     1e-5f },
+        { 96000.0f,  48000.0f,  GGWave::Resampler::kWidth,     1e-5f },
+        { 48000.0f,  96000.0f,  GGWave::Resampler::kWidth,     1e-5f },
+        { 48000.0f,  44100.0f,  GGWave::Resampler::kWidthFast, 1e-5f },
+        { 96000.0f,  44100.0f,  GGWave::Resampler::kWidthFast, 1e-5f },
+        { 48000.0f,  44130.87f, GGWave::Resampler::kWidth,     1e-3f },
+        { 44130.87f, 48000.0f,  GGWave::Resampler::kWidth,     1e-3f },
+        { 48000.0f,  44130.87f, GGWave::Resampler::kWidthFast, 1e-3f },
+        { 47999.0f,  44100.0f,  GGWave::Resampler::kWidth,     1e-3f },
+    };
+
+    for (const auto & c : resamplerCases) {
+        const float err = resamplerError(c.rateInp, c.rateOut, c.width);
+        const bool ok = err >= 0.0f && err <= c.tolerance;
+
+        printf("resampler %.2f -> %.2f Hz, width %2d: max error %.2e %s\n",
+               c.rateInp, c.rateOut, c.width, err, ok ? "ok" : "FAILED");
+
+        nFailed += ok ? 0 : 1;
+    }
+
+    if (nFailed > 0) {
+        printf("%d checks failed\n", nFailed);
+        return 1;
+    }
+
+    return 0;
+}